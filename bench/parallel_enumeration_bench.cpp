@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "windows_registry_manager.h"
+
+using namespace registry;
+
+namespace {
+
+// Scratch key under HKCU so the bench needs no elevation
+const char* const kBenchRoot = "HKEY_CURRENT_USER\\Software\\regedit-tui-bench";
+
+double MillisecondsPerCall(WindowsRegistryManager& manager, const std::string& path) {
+    using Clock = std::chrono::steady_clock;
+    size_t iterations = 0;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        manager.GetSubkeys(path);
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(300));
+    return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+// DeleteKey removes only empty keys, so clear the flat scratch tree first
+void RemoveBenchKeys(WindowsRegistryManager& manager) {
+    for (const auto& name : manager.GetSubkeys(kBenchRoot)) {
+        manager.DeleteKey(std::string(kBenchRoot) + "\\" + name);
+    }
+    manager.DeleteKey(kBenchRoot);
+}
+
+} // namespace
+
+int main() {
+    const size_t kCounts[] = {64, 256, 1024, 4096, 16384};
+    const unsigned kThreads[] = {2, 4, 8};
+
+    WindowsRegistryManager manager;
+    RemoveBenchKeys(manager);
+    if (!manager.CreateKey(kBenchRoot)) {
+        std::fprintf(stderr, "cannot create %s\n", kBenchRoot);
+        return 1;
+    }
+
+    std::printf("%-8s %12s", "subkeys", "serial ms");
+    for (unsigned threads : kThreads) {
+        std::printf(" %9u thr", threads);
+    }
+    std::printf("\n");
+
+    // Subkeys are added incrementally, so each row reuses the previous ones
+    size_t created = 0;
+    size_t crossover = 0;
+    for (size_t count : kCounts) {
+        for (; created < count; ++created) {
+            manager.CreateKey(std::string(kBenchRoot) + "\\key" + std::to_string(created));
+        }
+
+        manager.SetParallelEnumeration({});
+        double serial = MillisecondsPerCall(manager, kBenchRoot);
+        std::printf("%-8zu %12.3f", count, serial);
+
+        bool faster = false;
+        for (unsigned threads : kThreads) {
+            manager.SetParallelEnumeration({1, threads});
+            double parallel = MillisecondsPerCall(manager, kBenchRoot);
+            faster = faster || parallel < serial;
+            std::printf(" %9.3f ms", parallel);
+        }
+        std::printf("\n");
+
+        if (faster && crossover == 0) {
+            crossover = count;
+        }
+    }
+
+    if (crossover != 0) {
+        std::printf("parallel enumeration wins from about %zu subkeys\n", crossover);
+    } else {
+        std::printf("parallel enumeration did not win at any measured size\n");
+    }
+
+    RemoveBenchKeys(manager);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "text_encoding.h"
+
+using namespace registry;
+
+namespace {
+
+// Registry-like text: paths and value names are mostly ASCII, with the
+// occasional localized name
+struct Sample {
+    const char* name;
+    std::string utf8;
+};
+
+std::string Repeat(const std::string& unit, size_t bytes) {
+    std::string out;
+    while (out.size() < bytes) {
+        out += unit;
+    }
+    return out;
+}
+
+template <typename Fn>
+double MegabytesPerSecond(size_t bytes, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+    size_t iterations = 0;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        fn();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(300));
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return static_cast<double>(bytes) * iterations / seconds / (1024 * 1024);
+}
+
+} // namespace
+
+int main() {
+    const size_t kBytes = 1 << 20;
+    const Sample samples[] = {
+        {"ascii", Repeat("SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run\\", kBytes)},
+        {"short", Repeat("DisplayName\\", kBytes)},
+        {"latin1", Repeat("Param\xC3\xA8tres r\xC3\xA9gionaux\\", kBytes)},
+        {"cyrillic", Repeat("\xD0\x9F\xD0\xB0\xD1\x80\xD0\xB0\xD0\xBC\xD0\xB5\xD1\x82\xD1\x80\xD1\x8B\\", kBytes)},
+    };
+
+    std::printf("variant: %s\n", REGEDIT_TUI_BENCH_VARIANT);
+    std::printf("%-10s %14s %14s\n", "input", "utf8->16 MB/s", "utf16->8 MB/s");
+
+    std::u16string wide;
+    std::string narrow;
+    for (const auto& sample : samples) {
+        Utf8ToUtf16(sample.utf8, wide);
+        double widen = MegabytesPerSecond(sample.utf8.size(), [&] {
+            Utf8ToUtf16(sample.utf8, wide);
+        });
+        double narrowRate = MegabytesPerSecond(sample.utf8.size(), [&] {
+            Utf16ToUtf8(wide.data(), wide.size(), narrow);
+        });
+        if (narrow != sample.utf8) {
+            std::fprintf(stderr, "%s: round trip mismatch\n", sample.name);
+            return 1;
+        }
+        std::printf("%-10s %14.0f %14.0f\n", sample.name, widen, narrowRate);
+    }
+    return 0;
+}
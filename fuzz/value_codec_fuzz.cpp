@@ -0,0 +1,27 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include "value_codec.h"
+
+// The first input byte selects the raw type; the rest is the value data.
+// Decoding must stay within the input, and a decoded value must encode and
+// decode back to itself.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    registry::Value value;
+    value.rawType = data[0] % 16;
+    value.type = registry::ValueTypeFromRaw(value.rawType);
+    registry::DecodeValueData(value.type, data + 1, size - 1, value.data);
+
+    std::vector<uint8_t> encoded;
+    if (!registry::EncodeValueData(value, encoded) || registry::RawValueType(value) != value.rawType) {
+        std::abort();
+    }
+    if (registry::DecodeValueData(value.type, encoded.data(), encoded.size()) != value.data) {
+        std::abort();
+    }
+    return 0;
+}
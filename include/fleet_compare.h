@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "registry_manager.h"
+
+namespace registry {
+
+// One machine taking part in a comparison
+struct FleetSource {
+    std::string name;
+    RegistryFactory open;
+};
+
+// Contents of one key in a subtree snapshot. Values are sorted by name and
+// shared between all snapshots that contain an identical value.
+struct SnapshotKey {
+    std::string path;  // relative to the subtree root, "" for the root
+    std::vector<std::shared_ptr<const Value>> values;
+};
+
+// A subtree in canonical order: keys depth-first, siblings sorted by name
+using SubtreeSnapshot = std::vector<SnapshotKey>;
+
+// A group of machines whose subtrees are identical
+struct SubtreeVariant {
+    uint64_t hash = 0;
+    std::vector<std::string> machines;
+    std::shared_ptr<const SubtreeSnapshot> snapshot;
+};
+
+// Comparison of one subtree across the fleet
+struct SubtreeComparison {
+    std::string path;
+    std::vector<SubtreeVariant> variants;  // most common first
+    std::vector<std::string> missing;      // machines without the subtree
+};
+
+struct FleetReport {
+    std::vector<SubtreeComparison> subtrees;
+    std::vector<std::string> unavailable;  // sources that failed to open
+
+    // Whether large values (see ValueMemoryLimits) were compared by size
+    // and content hash rather than byte by byte
+    bool largeValuesHashed = false;
+};
+
+// Read `paths` from every source and group the machines by identical
+// subtree content. Sources are processed on `threads` worker threads (0
+// uses every core); each is opened, walked and closed before the worker
+// moves on, so only one source per thread is open at a time.
+//
+// Key and value names compare case-insensitively, as in the registry.
+// Identical values are interned across machines, so memory grows with the
+// number of distinct variants rather than the number of machines. Large
+// values are matched by size and a 64-bit hash of their contents, as their
+// sources are closed before other machines are read.
+FleetReport CompareFleet(const std::vector<FleetSource>& sources,
+                         const std::vector<std::string>& paths,
+                         unsigned threads = 0);
+
+// Render a report as text. Every variant other than the most common one is
+// an outlier and is listed with its differences from the most common one.
+std::string FormatFleetReport(const FleetReport& report);
+
+} // namespace registry
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+
+namespace registry {
+namespace hive {
+
+// On-disk layout of regf hive files. All integers are little-endian and
+// all cell offsets are relative to the start of the hive bins data, which
+// begins right after the 4096-byte base block.
+
+constexpr uint32_t kPageSize = 4096;
+constexpr uint32_t kBaseBlockSize = 4096;
+constexpr uint32_t kNoCell = 0xFFFFFFFF;
+
+// Base block
+constexpr uint32_t kBaseSignature = 0x66676572;  // "regf"
+constexpr uint32_t kBasePrimarySequence = 4;
+constexpr uint32_t kBaseSecondarySequence = 8;
+constexpr uint32_t kBaseTimestamp = 12;
+constexpr uint32_t kBaseMajorVersion = 20;
+constexpr uint32_t kBaseMinorVersion = 24;
+constexpr uint32_t kBaseFileType = 28;
+constexpr uint32_t kBaseRootCell = 36;
+constexpr uint32_t kBaseBinsSize = 40;
+constexpr uint32_t kBaseChecksum = 508;
+
+constexpr uint32_t kFileTypePrimary = 0;
+constexpr uint32_t kFileTypeLog = 1;
+constexpr uint32_t kFileTypeLogAlternate = 2;
+constexpr uint32_t kFileTypeLogNew = 6;
+
+// Hive bin header
+constexpr uint32_t kBinSignature = 0x6E696268;  // "hbin"
+constexpr uint32_t kBinHeaderSize = 32;
+constexpr uint32_t kBinOffset = 4;
+constexpr uint32_t kBinSize = 8;
+constexpr uint32_t kBinTimestamp = 20;
+
+// Cell signatures (first two payload bytes)
+constexpr uint16_t kKeyNodeSignature = 0x6B6E;    // "nk"
+constexpr uint16_t kValueSignature = 0x6B76;      // "vk"
+constexpr uint16_t kSecuritySignature = 0x6B73;   // "sk"
+constexpr uint16_t kIndexLeafSignature = 0x696C;  // "li"
+constexpr uint16_t kFastLeafSignature = 0x666C;   // "lf"
+constexpr uint16_t kHashLeafSignature = 0x686C;   // "lh"
+constexpr uint16_t kIndexRootSignature = 0x6972;  // "ri"
+constexpr uint16_t kBigDataSignature = 0x6264;    // "db"
+
+// Key node (nk) payload fields
+constexpr uint32_t kKeyFlags = 2;
+constexpr uint32_t kKeyTimestamp = 4;
+constexpr uint32_t kKeyParent = 16;
+constexpr uint32_t kKeySubkeyCount = 20;
+constexpr uint32_t kKeySubkeyList = 28;
+constexpr uint32_t kKeyValueCount = 36;
+constexpr uint32_t kKeyValueList = 40;
+constexpr uint32_t kKeySecurity = 44;
+constexpr uint32_t kKeyClassName = 48;
+constexpr uint32_t kKeyMaxSubkeyName = 52;
+constexpr uint32_t kKeyMaxValueName = 60;
+constexpr uint32_t kKeyMaxValueData = 64;
+constexpr uint32_t kKeyNameLength = 72;
+constexpr uint32_t kKeyClassNameLength = 74;
+constexpr uint32_t kKeyName = 76;
+
+constexpr uint16_t kKeyFlagRoot = 0x0004;
+constexpr uint16_t kKeyFlagCompressedName = 0x0020;
+
+// Value (vk) payload fields
+constexpr uint32_t kValueNameLength = 2;
+constexpr uint32_t kValueDataSize = 4;
+constexpr uint32_t kValueDataOffset = 8;
+constexpr uint32_t kValueType = 12;
+constexpr uint32_t kValueFlags = 16;
+constexpr uint32_t kValueName = 20;
+
+constexpr uint16_t kValueFlagCompressedName = 0x0001;
+constexpr uint32_t kValueDataResident = 0x80000000;
+
+// Security (sk) payload fields
+constexpr uint32_t kSecurityFlink = 4;
+constexpr uint32_t kSecurityBlink = 8;
+constexpr uint32_t kSecurityRefCount = 12;
+
+// Subkey list payload: signature, count, then 4-byte (li, ri) or 8-byte
+// (lf, lh) entries
+constexpr uint32_t kListCount = 2;
+constexpr uint32_t kListEntries = 4;
+
+// Big data (db) payload fields, used for values larger than a single cell
+// can hold in hives of version 1.4 and later
+constexpr uint32_t kBigDataSegmentCount = 2;
+constexpr uint32_t kBigDataSegmentList = 4;
+constexpr uint32_t kBigDataSegmentSize = 16344;
+
+// Transaction logs. Both formats start with a copy of the first sector of
+// the base block. The old format (.LOG) follows it with a dirty vector:
+// one bit per 512-byte sector of hive bins data, then the dirty sectors in
+// order. The new format (.LOG1/.LOG2) follows it with log entries, each
+// listing dirty page ranges followed by their contents.
+constexpr uint32_t kLogSectorSize = 512;
+constexpr uint32_t kDirtyVectorSignature = 0x54524944;  // "DIRT"
+
+constexpr uint32_t kLogEntrySignature = 0x454C7648;     // "HvLE"
+constexpr uint32_t kLogEntrySize = 4;
+constexpr uint32_t kLogEntrySequence = 12;
+constexpr uint32_t kLogEntryBinsSize = 16;
+constexpr uint32_t kLogEntryPageCount = 20;
+constexpr uint32_t kLogEntryDataHash = 24;
+constexpr uint32_t kLogEntryHeaderHash = 32;
+constexpr uint32_t kLogEntryPages = 40;
+constexpr uint64_t kLogEntryHashSeed = 0x82EF4D887A4E55C5ULL;
+
+} // namespace hive
+} // namespace registry
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace registry {
+
+class MappedFile;
+
+// Copy-on-write view of a regf hive file.
+//
+// The base file is memory-mapped read-only. Modifications are staged in a
+// sparse map of 4 KiB pages that overlays the mapping; Save() writes only
+// those pages (plus the base block) back to the file, so editing a large
+// hive costs I/O proportional to the change, not the file size.
+//
+// Dirty hives are recovered the same way: pages from the transaction logs
+// are laid over the mapping, so the merged view costs roughly the size of
+// the logs rather than a copy of the hive.
+//
+// Offsets passed to Read/Write and cell offsets are relative to the start
+// of the hive bins data, as stored in the file.
+class HiveImage {
+public:
+    ~HiveImage();
+
+    // Map a hive file. Returns nullptr if it is not a valid regf file.
+    static std::unique_ptr<HiveImage> Open(const std::string& path);
+
+    // Base block fields
+    uint32_t RootCell() const;
+    uint32_t BinsSize() const;
+    uint32_t MinorVersion() const;
+
+    // Whether the primary file was not cleanly written (its sequence
+    // numbers differ) and needs its transaction logs replayed
+    bool IsDirty() const;
+
+    // Replay transaction logs (.LOG, .LOG1, .LOG2) of a dirty hive. Entries
+    // already reflected in the primary file are skipped and replay stops at
+    // the first gap in sequence numbers. Missing or invalid logs are
+    // ignored. Returns true if any log data was applied.
+    bool Recover(const std::vector<std::string>& logPaths);
+
+    // Whether Recover() applied log data
+    bool WasRecovered() const { return recovered_; }
+
+    // Raw access to hive bins data
+    bool Read(uint32_t offset, void* out, size_t size) const;
+    bool Write(uint32_t offset, const void* data, size_t size);
+    uint16_t ReadU16(uint32_t offset) const;
+    uint32_t ReadU32(uint32_t offset) const;
+    bool WriteU16(uint32_t offset, uint16_t value);
+    bool WriteU32(uint32_t offset, uint32_t value);
+
+    // Incremented by every write, so readers holding cell offsets can tell
+    // that the cells may have been freed or reused since
+    uint64_t Generation() const { return generation_; }
+
+    // Distinct for every opened image, including reopenings of one file
+    uint64_t Id() const { return id_; }
+
+    // Read the payload of an allocated cell
+    bool ReadCell(uint32_t cell, std::vector<uint8_t>& out) const;
+
+    // Usable payload size of an allocated cell, or 0 if `cell` is invalid
+    uint32_t CellCapacity(uint32_t cell) const;
+
+    // Allocate a cell with at least `size` payload bytes. Free cells are
+    // reused (best fit) before the hive is grown by a new bin. Returns
+    // hive::kNoCell on failure.
+    uint32_t AllocateCell(uint32_t size);
+
+    // Return a cell to the free pool, merging it with free neighbours
+    void FreeCell(uint32_t cell);
+
+    // Whether there are staged changes not yet written by Save()
+    bool HasUnsavedChanges() const;
+
+    // Write staged pages (and any recovered log pages) and the updated base
+    // block back to the hive file
+    bool Save();
+
+    // Write the complete merged hive to another file. Fails if `path` is
+    // the hive's own file.
+    bool SaveAs(const std::string& path) const;
+
+    // Bytes held by staged pages
+    size_t OverlayBytes() const;
+
+    // Bytes of the mapped file currently resident in memory
+    size_t ResidentBytes() const;
+
+private:
+    HiveImage() = default;
+
+    const uint8_t* PageData(uint32_t page) const;
+    uint8_t* MutablePage(uint32_t page);
+    void ApplyRecovered(uint32_t offset, const uint8_t* data, uint32_t size);
+    bool FindBin(uint32_t offset, uint32_t& binOffset, uint32_t& binSize) const;
+    bool ScanNextBin();
+    uint32_t AppendBin(uint32_t cellSize);
+    void UpdateBaseBlock(uint32_t primary, uint32_t secondary);
+
+    std::string path_;
+    std::unique_ptr<MappedFile> file_;
+    std::vector<uint8_t> base_block_;
+
+    // Staged pages keyed by page index within the hive bins data
+    std::map<uint32_t, std::vector<uint8_t>> pages_;
+    std::set<uint32_t> dirty_pages_;
+    std::set<uint32_t> recovered_pages_;
+    bool base_block_dirty_ = false;
+    bool recovered_ = false;
+    uint64_t generation_ = 0;
+    uint64_t id_ = 0;
+
+    // Free cells as (size, offset), indexed for bins below scan_cursor_.
+    // Bins are scanned lazily, only when no indexed free cell fits.
+    std::set<std::pair<uint32_t, uint32_t>> free_cells_;
+    uint32_t scan_cursor_ = 0;
+};
+
+} // namespace registry
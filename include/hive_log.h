@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace registry {
+
+// A parsed hive transaction log (.LOG, .LOG1 or .LOG2).
+//
+// The log file is read once into memory; entries refer into that buffer,
+// so replaying a log never copies more than the dirty pages it contains.
+// Only entries that pass validation (signatures, bounds and, for the new
+// format, both Marvin32 hashes) are exposed, and they stop at the first
+// invalid one, the same way Windows treats a torn log.
+class HiveLog {
+public:
+    // A dirty byte range of hive bins data
+    struct Page {
+        uint32_t offset;
+        uint32_t size;
+        const uint8_t* data;
+    };
+
+    // Pages written by the hive write numbered `sequence`
+    struct Entry {
+        uint32_t sequence;
+        uint32_t binsSize;
+        std::vector<Page> pages;
+    };
+
+    // Read and validate a log file. Returns nullptr if it is missing or not
+    // a usable log.
+    static std::unique_ptr<HiveLog> Read(const std::string& path);
+
+    // Primary sequence number from the log's base block
+    uint32_t Sequence() const { return sequence_; }
+
+    // Root cell offset from the log's base block
+    uint32_t RootCell() const { return root_cell_; }
+
+    // Whether this is a new-format (.LOG1/.LOG2) log of HvLE entries rather
+    // than an old-format dirty vector
+    bool IsNewFormat() const { return new_format_; }
+
+    const std::vector<Entry>& Entries() const { return entries_; }
+
+private:
+    HiveLog() = default;
+
+    bool ParseDirtyVector(uint32_t binsSize);
+    bool ParseEntries();
+
+    std::vector<uint8_t> data_;
+    uint32_t sequence_ = 0;
+    uint32_t root_cell_ = 0;
+    bool new_format_ = false;
+    std::vector<Entry> entries_;
+};
+
+// Marvin32 hash, used to checksum new-format log entries
+uint64_t Marvin32(const uint8_t* data, size_t size, uint64_t seed);
+
+} // namespace registry
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "path_table.h"
+#include "registry_manager.h"
+
+namespace registry {
+
+class HiveImage;
+
+// RegistryManager backed by an offline regf hive file (e.g. a SYSTEM or
+// SOFTWARE hive copied off a machine). Works on any platform.
+//
+// Paths are relative to the hive's root key ("" is the root itself),
+// backslash-separated and matched case-insensitively. Modifications are
+// staged in memory and only reach the file when Save() is called; Save()
+// writes just the pages that changed.
+//
+// A dirty hive (one with pending changes only in its transaction logs) is
+// shown as Windows would load it: the logs are replayed over the mapped
+// file on open. Saving such a hive also writes the recovered pages. If no
+// log can be replayed the hive is opened read-only, since writing it would
+// mark it consistent and lose the pending log data for good.
+class HiveRegistryManager : public RegistryManager {
+public:
+    ~HiveRegistryManager() override;
+
+    // Open a hive file, replaying `path`.LOG1, .LOG2 and .LOG if the hive
+    // is dirty. Returns nullptr if it cannot be mapped or parsed.
+    static std::unique_ptr<HiveRegistryManager> Open(const std::string& path);
+
+    // Open a hive file, replaying the given transaction logs if it is dirty
+    static std::unique_ptr<HiveRegistryManager> Open(const std::string& path,
+                                                     const std::vector<std::string>& logPaths);
+
+    using RegistryManager::CreateKey;
+
+    std::optional<Key> OpenKey(const std::string& path) override;
+    std::vector<Value> GetValues(const std::string& path) override;
+    std::vector<std::string> GetSubkeys(const std::string& path) override;
+    bool CreateKey(const std::string& path) override;
+    bool DeleteKey(const std::string& path) override;
+    bool SetValue(const std::string& path, const Value& value) override;
+    bool DeleteValue(const std::string& path, const std::string& valueName) override;
+
+    // Key-ID operations resolve through a per-ID cell cache
+    std::optional<Key> OpenKey(KeyId key) override;
+    std::vector<Value> GetValues(KeyId key) override;
+    std::vector<std::string> GetSubkeys(KeyId key) override;
+    bool DeleteKey(KeyId key) override;
+    bool SetValue(KeyId key, const Value& value) override;
+    bool DeleteValue(KeyId key, const std::string& valueName) override;
+
+    // Staged pages, the resident part of the mapped file and cached value
+    // chunks
+    size_t MemoryUsage() const override;
+
+    // Whether there are staged changes not yet written to the file
+    bool HasUnsavedChanges() const override;
+
+    // Whether transaction log data was replayed when the hive was opened
+    bool ReplayedLogs() const;
+
+    // Whether the hive is dirty but its logs could not be replayed; edits
+    // and SaveAs() are refused
+    bool IsReadOnly() const { return read_only_; }
+
+    // Write staged changes back to the hive file in place
+    bool Save() override;
+
+    // Write the complete hive, including staged changes, to a new file
+    bool SaveAs(const std::string& path) const;
+
+private:
+    explicit HiveRegistryManager(std::unique_ptr<HiveImage> image);
+
+    // Helper methods
+    std::optional<Key> OpenKeyAt(uint32_t cell, const std::string& path) const;
+    std::vector<Value> GetValuesAt(uint32_t key) const;
+    std::vector<std::string> GetSubkeysAt(uint32_t key) const;
+    bool DeleteKeyAt(uint32_t key);
+    bool SetValueAt(uint32_t key, const Value& value);
+    bool DeleteValueAt(uint32_t key, const std::string& valueName);
+    uint32_t FindKey(const std::string& path) const;
+    uint32_t FindKey(KeyId id) const;
+    uint32_t FindChild(uint32_t key, const std::u16string& name) const;
+    uint32_t CreateChild(uint32_t parent, const std::u16string& name);
+    bool InsertSubkey(uint32_t parent, uint32_t child);
+    bool RemoveSubkey(uint32_t parent, uint32_t child);
+    std::vector<uint32_t> GetValueCells(uint32_t key) const;
+    bool ReadValueBytes(uint32_t valueCell, std::vector<uint8_t>& out) const;
+    uint32_t StoreValueBytes(const std::vector<uint8_t>& data, uint32_t& sizeField);
+    void FreeValueBytes(uint32_t valueCell);
+    void FreeDataCells(uint32_t sizeField, uint32_t dataOffset);
+    void ReleaseSecurity(uint32_t security);
+    void TouchKey(uint32_t key);
+
+    // Shared so that large-value handles can detect when it is closed
+    std::shared_ptr<HiveImage> image_;
+
+    // nk cell of each KeyId resolved so far (kNoCell if not cached)
+    mutable std::vector<uint32_t> key_cells_;
+
+    bool read_only_ = false;
+};
+
+} // namespace registry
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include "hive_format.h"
+
+namespace registry {
+namespace hive {
+
+// Little-endian field access for hive structures, which may be unaligned
+inline uint16_t LoadU16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+inline uint32_t LoadU32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+inline uint64_t LoadU64(const uint8_t* data) {
+    return static_cast<uint64_t>(LoadU32(data)) | (static_cast<uint64_t>(LoadU32(data + 4)) << 32);
+}
+
+inline void StoreU16(uint8_t* data, uint16_t value) {
+    data[0] = static_cast<uint8_t>(value);
+    data[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline void StoreU32(uint8_t* data, uint32_t value) {
+    data[0] = static_cast<uint8_t>(value);
+    data[1] = static_cast<uint8_t>(value >> 8);
+    data[2] = static_cast<uint8_t>(value >> 16);
+    data[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// Base block checksum: XOR of the first 127 dwords, with 0 and -1 remapped
+inline uint32_t BaseBlockChecksum(const uint8_t* block) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < kBaseChecksum; i += 4) {
+        sum ^= LoadU32(block + i);
+    }
+    if (sum == 0xFFFFFFFF) {
+        return 0xFFFFFFFE;
+    }
+    if (sum == 0) {
+        return 1;
+    }
+    return sum;
+}
+
+// Current time as a FILETIME: 100ns intervals since 1601-01-01
+inline uint64_t CurrentFileTime() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto ticks = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() / 100;
+    return static_cast<uint64_t>(ticks) + 116444736000000000ULL;
+}
+
+} // namespace hive
+} // namespace registry
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "registry_manager.h"
+
+namespace registry {
+
+// Composes several registry sources under one virtual namespace, e.g.
+//
+//   HOST1\HKLM\SOFTWARE  -> SOFTWARE hive of machine 1
+//   HOST1\HKLM\SYSTEM    -> SYSTEM hive of machine 1
+//   HOST2\HKLM\SOFTWARE  -> ...
+//
+// Paths are routed to the mount with the longest matching prefix (matched
+// case-insensitively, component by component, in a trie). Path components
+// above the mounts appear as virtual keys with no values.
+//
+// Sources are opened lazily on first access. When the combined
+// MemoryUsage() of open sources exceeds the budget, the least recently
+// used ones without unsaved changes are closed; they are reopened
+// transparently when accessed again. Sources with unsaved changes stay
+// open until they are saved.
+class MountedRegistryManager : public RegistryManager {
+public:
+    // A budget of 0 means unlimited
+    explicit MountedRegistryManager(size_t memoryBudget = 0);
+    ~MountedRegistryManager() override;
+
+    // Mount a source under `prefix`. Paths below the prefix are forwarded
+    // with `target` prepended (e.g. target "HKEY_LOCAL_MACHINE" for a live
+    // registry). Fails if the prefix is empty or already mounted.
+    bool Mount(const std::string& prefix, RegistryFactory factory, const std::string& target = "");
+
+    // Remove a mount, closing its source. Fails if it has unsaved changes.
+    bool Unmount(const std::string& prefix);
+
+    // Mounted prefixes
+    std::vector<std::string> GetMounts() const;
+
+    // Set the memory budget and close sources until it is met
+    void SetMemoryBudget(size_t bytes);
+
+    using RegistryManager::OpenKey;
+    using RegistryManager::GetValues;
+    using RegistryManager::GetSubkeys;
+    using RegistryManager::CreateKey;
+    using RegistryManager::DeleteKey;
+    using RegistryManager::SetValue;
+    using RegistryManager::DeleteValue;
+
+    std::optional<Key> OpenKey(const std::string& path) override;
+    std::vector<Value> GetValues(const std::string& path) override;
+    std::vector<std::string> GetSubkeys(const std::string& path) override;
+    bool CreateKey(const std::string& path) override;
+    bool DeleteKey(const std::string& path) override;
+    bool SetValue(const std::string& path, const Value& value) override;
+    bool DeleteValue(const std::string& path, const std::string& valueName) override;
+    void SetValueMemoryLimits(const ValueMemoryLimits& limits) override;
+    void SetParallelEnumeration(const ParallelEnumeration& options) override;
+    size_t MemoryUsage() const override;
+    bool HasUnsavedChanges() const override;
+
+    // Save every source with unsaved changes. Returns false if any failed;
+    // the others are still saved.
+    bool Save() override;
+
+    // Save the source mounted at `prefix`
+    bool Save(const std::string& prefix);
+
+    // Prefixes of mounts with unsaved changes
+    std::vector<std::string> GetUnsavedMounts() const;
+
+private:
+    struct MountPoint {
+        std::string prefix;
+        std::string target;
+        RegistryFactory factory;
+        std::unique_ptr<RegistryManager> manager;
+        uint64_t lastUse = 0;
+
+        // MemoryUsage() of the open source as of `usageTime`
+        size_t usage = 0;
+        std::chrono::steady_clock::time_point usageTime;
+    };
+
+    // Trie node for one path component
+    struct Node {
+        std::string name;
+        std::map<std::string, std::unique_ptr<Node>> children;
+        std::unique_ptr<MountPoint> mount;
+    };
+
+    // Result of routing a path
+    struct Route {
+        const Node* node = nullptr;   // deepest trie node matched (virtual key)
+        MountPoint* mount = nullptr;  // longest-prefix mount, if any
+        std::string path;             // path to use within the mount
+        bool exact = false;           // whole path matched trie nodes
+    };
+
+    Route Resolve(const std::string& path) const;
+    MountPoint* FindMount(const std::string& prefix) const;
+    RegistryManager* Acquire(MountPoint& mount);
+    void EnforceBudget(const MountPoint* keep);
+    void CollectMounts(const Node& node, std::vector<MountPoint*>& out) const;
+
+    Node root_;
+    size_t memory_budget_;
+    uint64_t clock_ = 0;
+};
+
+} // namespace registry
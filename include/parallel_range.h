@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace registry {
+
+// Split the index range [0, count) into contiguous chunks, one per thread
+// (at most `maxThreads`, 0 meaning every core), and call
+// fn(begin, end, out) for each chunk. The first chunk runs on the calling
+// thread. Returns the chunk outputs concatenated in index order.
+template <typename T, typename Fn>
+std::vector<T> EnumerateInParallel(size_t count, unsigned maxThreads, Fn fn) {
+    size_t threads = maxThreads != 0 ? maxThreads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, count));
+
+    std::vector<std::vector<T>> chunks(threads);
+    std::vector<std::thread> workers;
+    size_t chunkSize = count / threads;
+    size_t remainder = count % threads;
+    size_t begin = 0;
+    for (size_t i = 0; i < threads; ++i) {
+        size_t end = begin + chunkSize + (i < remainder ? 1 : 0);
+        if (i == 0) {
+            begin = end;
+            continue;
+        }
+        workers.emplace_back([&fn, &chunks, i, begin, end]() {
+            fn(begin, end, chunks[i]);
+        });
+        begin = end;
+    }
+    fn(0, chunkSize + (remainder > 0 ? 1 : 0), chunks[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<T> result;
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        total += chunk.size();
+    }
+    result.reserve(total);
+    for (auto& chunk : chunks) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(result));
+    }
+    return result;
+}
+
+} // namespace registry
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace registry {
+
+// Stable 4-byte handle for an interned key path
+using KeyId = uint32_t;
+
+constexpr KeyId kRootKeyId = 0;
+constexpr KeyId kInvalidKeyId = 0xFFFFFFFF;
+
+// Interns registry key paths as KeyIds with parent links, so navigation,
+// caches and search results can pass small handles instead of strings.
+// The root ("") is always kRootKeyId. Child lookup is one hash probe on
+// (parent, name) and the full path of each key is built once, when it is
+// interned. Names match case-insensitively; the first spelling seen is
+// kept. IDs are never reused, even if the key is deleted. Not thread-safe.
+class PathTable {
+public:
+    PathTable();
+
+    // ID of `name` under `parent`, interning it if needed. Returns
+    // kInvalidKeyId if `parent` is not a valid ID.
+    KeyId Child(KeyId parent, const std::string& name);
+
+    // ID of `name` under `parent` if already interned, else kInvalidKeyId
+    KeyId FindChild(KeyId parent, const std::string& name) const;
+
+    // ID of a backslash-separated path, interning each component
+    KeyId Intern(const std::string& path);
+
+    // Parent of `id`; kInvalidKeyId for the root and invalid IDs
+    KeyId Parent(KeyId id) const;
+
+    // Last path component and full path; empty for the root and invalid IDs
+    const std::string& Name(KeyId id) const;
+    const std::string& Path(KeyId id) const;
+
+    bool IsValid(KeyId id) const { return id < entries_.size(); }
+    size_t Size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        KeyId parent;
+        std::string name;
+        std::string path;
+    };
+
+    // Lookup key: parent ID followed by the case-folded name
+    static std::string ChildKey(KeyId parent, const std::string& name);
+
+    std::deque<Entry> entries_;  // deque keeps Name/Path references stable
+    std::unordered_map<std::string, KeyId> children_;
+};
+
+} // namespace registry
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <memory>
 #include <variant>
 #include <optional>
+#include "path_table.h"
 
 namespace registry {
 
@@ -25,19 +29,45 @@ enum class ValueType {
 
 // Registry value data
 using ValueData = std::variant<
-    std::monostate,           // REG_NONE
+    std::monostate,           // no data (e.g. a large value)
     std::string,              // REG_SZ, REG_EXPAND_SZ
-    std::vector<uint8_t>,     // REG_BINARY
+    std::vector<uint8_t>,     // REG_BINARY, REG_NONE and unmapped types
     uint32_t,                 // REG_DWORD, REG_DWORD_BIG_ENDIAN
     uint64_t,                 // REG_QWORD
     std::vector<std::string>  // REG_MULTI_SZ
 >;
 
+// Raw data of a value too large to load eagerly, read in chunks on demand.
+// Bytes are in the stored encoding (UTF-16LE for strings).
+class LargeValue {
+public:
+    virtual ~LargeValue() = default;
+
+    // Size of the raw data in bytes
+    virtual size_t Size() const = 0;
+
+    // Copy up to `size` bytes starting at `offset` into `out`. Returns the
+    // number of bytes copied, which is short at the end of the data or if
+    // the value can no longer be read (e.g. it was modified meanwhile).
+    virtual size_t ReadChunk(size_t offset, uint8_t* out, size_t size) const = 0;
+
+    // Write all of the raw data to `out` a chunk at a time
+    bool StreamTo(std::ostream& out) const;
+};
+
 // Registry value
 struct Value {
     std::string name;
     ValueType type;
     ValueData data;
+
+    // Set instead of `data` for values above the large-value threshold.
+    // Such values are read-only: SetValue rejects them.
+    std::shared_ptr<const LargeValue> large = nullptr;
+
+    // Stored REG_* code, which is written back for UNKNOWN types (e.g.
+    // REG_FULL_RESOURCE_DESCRIPTOR); ignored for mapped types
+    uint32_t rawType = 0;
 };
 
 // Registry key
@@ -48,6 +78,26 @@ struct Key {
     std::vector<std::string> subkeys;
 };
 
+// Settings for enumerating the subkeys of very wide keys on several
+// threads. Disabled by default: the crossover where the extra handles and
+// threads pay off depends on the machine and must be measured there.
+struct ParallelEnumeration {
+    size_t threshold = 0;     // minimum subkey count; 0 disables
+    unsigned maxThreads = 0;  // 0 uses every core
+};
+
+// Limits on value data held in memory. Values larger than the threshold
+// are returned as LargeValue handles; chunks read through them are kept in
+// a cache bounded by bytes. The smaller values of one key that are loaded
+// eagerly count against the same budget, and once it would be exceeded
+// the rest are returned as handles as well. Disabled by default.
+struct ValueMemoryLimits {
+    size_t largeValueThreshold = 0;  // bytes; 0 loads every value eagerly
+    size_t chunkCacheBytes = 0;      // 0 caches nothing
+};
+
+class ChunkCache;
+
 // Registry manager interface
 class RegistryManager {
 public:
@@ -73,6 +123,47 @@ public:
     
     // Delete a value
     virtual bool DeleteValue(const std::string& path, const std::string& valueName) = 0;
+
+    // Key-ID addressing. IDs come from Paths(); by default they are
+    // resolved to their interned path, backends may cache per ID instead.
+    virtual std::optional<Key> OpenKey(KeyId key) { return OpenKey(paths_.Path(key)); }
+    virtual std::vector<Value> GetValues(KeyId key) { return GetValues(paths_.Path(key)); }
+    virtual std::vector<std::string> GetSubkeys(KeyId key) { return GetSubkeys(paths_.Path(key)); }
+    virtual bool CreateKey(KeyId key) { return CreateKey(paths_.Path(key)); }
+    virtual bool DeleteKey(KeyId key) { return DeleteKey(paths_.Path(key)); }
+    virtual bool SetValue(KeyId key, const Value& value) { return SetValue(paths_.Path(key), value); }
+    virtual bool DeleteValue(KeyId key, const std::string& valueName) { return DeleteValue(paths_.Path(key), valueName); }
+
+    // Bound the memory used for value data. Virtual so that composite
+    // managers can pass the limits on to their sources.
+    virtual void SetValueMemoryLimits(const ValueMemoryLimits& limits);
+    const ValueMemoryLimits& GetValueMemoryLimits() const { return value_limits_; }
+
+    // Like SetValueMemoryLimits, but read chunks through `cache`, which is
+    // shared with other managers and budgeted by whoever created it
+    void ShareValueMemoryLimits(const ValueMemoryLimits& limits, std::shared_ptr<ChunkCache> cache);
+
+    // Subkeys of a key as interned IDs
+    std::vector<KeyId> GetSubkeyIds(KeyId key);
+
+    // Paths interned for this manager
+    PathTable& Paths() { return paths_; }
+    const PathTable& Paths() const { return paths_; }
+
+    // Approximate bytes of memory held by this manager, used for budgeting
+    virtual size_t MemoryUsage() const { return 0; }
+
+    // Whether closing this manager would lose changes
+    virtual bool HasUnsavedChanges() const { return false; }
+
+    // Write pending changes to the backing store. Backends that apply
+    // changes immediately have nothing to do.
+    virtual bool Save() { return true; }
+
+    // Opt in to parallel subkey enumeration; backends that cannot benefit
+    // ignore it. Virtual so that composite managers can pass it on.
+    virtual void SetParallelEnumeration(const ParallelEnumeration& options) { parallel_enumeration_ = options; }
+    const ParallelEnumeration& GetParallelEnumeration() const { return parallel_enumeration_; }
     
     // Convert value type to string
     static std::string ValueTypeToString(ValueType type);
@@ -82,6 +173,20 @@ public:
     
     // Factory method to create platform-specific registry manager
     static std::unique_ptr<RegistryManager> Create();
+
+protected:
+    // Bytes held by the chunk cache, or 0 if it is shared; a shared cache
+    // is counted once, by its owner
+    size_t OwnChunkCacheBytes() const;
+
+    ParallelEnumeration parallel_enumeration_;
+    PathTable paths_;
+    ValueMemoryLimits value_limits_;
+    std::shared_ptr<ChunkCache> chunk_cache_;  // null when caching is off
+    bool chunk_cache_shared_ = false;
 };
 
+// Opens a registry source on demand
+using RegistryFactory = std::function<std::unique_ptr<RegistryManager>()>;
+
 } // namespace registry
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace registry {
+
+// Convert UTF-8 to UTF-16. Invalid sequences are replaced with U+FFFD.
+// The output buffer is overwritten but keeps its capacity, so repeated
+// conversions into the same buffer do not allocate.
+void Utf8ToUtf16(const char* data, size_t size, std::u16string& out);
+void Utf8ToUtf16(const std::string& str, std::u16string& out);
+
+// Convert UTF-16 to UTF-8. Unpaired surrogates are replaced with U+FFFD.
+void Utf16ToUtf8(const char16_t* data, size_t size, std::string& out);
+std::string Utf16ToUtf8(const char16_t* data, size_t size);
+
+// Convert UTF-16LE bytes (as stored in value data and hive files) to UTF-8.
+// A trailing odd byte is ignored. Works on unaligned input.
+void Utf16LeToUtf8(const uint8_t* data, size_t size, std::string& out);
+
+// Uppercase one UTF-16 code unit the way the registry folds key and value
+// names (the equivalent of RtlUpcaseUnicodeChar). Used for comparing,
+// sorting and hashing names.
+char16_t UpcaseChar(char16_t c);
+
+// Fold a UTF-8 key or value name with UpcaseChar, for use as a lookup key:
+// two names fold to the same string exactly when the registry treats them
+// as the same name. AppendFoldedCase appends to `out`.
+std::string FoldCase(const std::string& name);
+void AppendFoldedCase(const std::string& name, std::string& out);
+
+// Per-thread scratch buffers used at API boundaries (key paths, value
+// names, string data, raw value bytes). Each slot keeps its capacity
+// between calls.
+struct WideScratch {
+    std::u16string path;
+    std::u16string name;
+    std::u16string data;
+    std::vector<uint8_t> bytes;
+};
+
+// Get the scratch buffers for the calling thread
+WideScratch& ThreadWideScratch();
+
+// Grow a buffer to at least `units` code units without shrinking it
+void EnsureWideSize(std::u16string& buffer, size_t units);
+
+} // namespace registry
@@ -14,6 +14,9 @@ namespace ui {
 class UIManager {
 public:
     UIManager();
+
+    // Browse the given registry source, starting at `startPath`
+    UIManager(std::unique_ptr<registry::RegistryManager> registryManager, std::string startPath);
     ~UIManager() = default;
 
     // Run the UI
@@ -23,8 +26,8 @@ private:
     // Registry manager
     std::unique_ptr<registry::RegistryManager> registry_manager_;
 
-    // Current path in registry
-    std::string current_path_;
+    // Current key in registry, interned in the manager's path table
+    registry::KeyId current_key_;
 
     // Current selected key
     std::string selected_key_;
@@ -36,6 +39,12 @@ private:
     enum class View { Keys, Values };
     View current_view_;
 
+    // Message shown in the status bar after an action
+    std::string status_message_;
+
+    // Exit was requested with unsaved changes; a second request discards them
+    bool exit_pending_ = false;
+
     // UI components
     ftxui::Component main_container_;
     ftxui::ScreenInteractive screen_;
@@ -58,6 +67,9 @@ private:
     // Create the help bar
     ftxui::Component CreateHelpBar();
 
+    // Full path of the current key
+    const std::string& CurrentPath() const;
+
     // Navigation handlers
     void NavigateToParent();
     void NavigateToChild(const std::string& child);
@@ -72,6 +84,8 @@ private:
     void ImportRegistry();
     void ExportRegistry();
     void SearchRegistry();
+    void SaveChanges();
+    void RequestExit();
 };
 
 } // namespace ui
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "registry_manager.h"
+
+namespace registry {
+
+// Chunks are read, cached and streamed in units of this many bytes
+constexpr size_t kValueChunkSize = 64 * 1024;
+
+// Identifies a value's data independently of any handle, so chunks read
+// through one handle serve later handles to the same unchanged value
+struct ValueIdentity {
+    uint64_t source = 0;   // hive image or root key holding the value
+    uint64_t version = 0;  // changes whenever the data may have changed
+    uint64_t item = 0;     // the value within its source
+
+    // Name of the value within its source, for sources that address values
+    // by name rather than by offset; `item` is then a hash of it
+    std::string name;
+
+    bool operator==(const ValueIdentity& other) const {
+        return source == other.source && version == other.version && item == other.item &&
+               name == other.name;
+    }
+};
+
+// LRU cache of value data chunks, bounded by total bytes rather than by
+// entry count. Shared by all large-value handles of a manager (or of a
+// mount table), and safe to use from several threads.
+class ChunkCache {
+public:
+    using Chunk = std::shared_ptr<const std::vector<uint8_t>>;
+
+    explicit ChunkCache(size_t budget);
+
+    // Cached chunk `index` of value `owner`, or nullptr
+    Chunk Find(const ValueIdentity& owner, size_t index);
+
+    // Add a chunk, evicting least recently used ones to stay in budget.
+    // Chunks larger than the whole budget are not cached.
+    void Insert(const ValueIdentity& owner, size_t index, Chunk chunk);
+
+    void SetBudget(size_t bytes);
+    size_t Budget() const;
+    size_t Bytes() const;
+
+private:
+    struct EntryKey {
+        ValueIdentity owner;
+        size_t index;
+
+        bool operator==(const EntryKey& other) const {
+            return owner == other.owner && index == other.index;
+        }
+    };
+
+    struct EntryKeyHash {
+        size_t operator()(const EntryKey& key) const;
+    };
+
+    struct Entry {
+        EntryKey key;
+        Chunk chunk;
+    };
+
+    void Evict();
+
+    mutable std::mutex mutex_;
+    size_t budget_;
+    size_t bytes_ = 0;
+    std::list<Entry> entries_;  // most recently used first
+    std::unordered_map<EntryKey, std::list<Entry>::iterator, EntryKeyHash> index_;
+};
+
+// LargeValue that reads through a ChunkCache. Subclasses load one chunk
+// at a time from their source.
+class CachedLargeValue : public LargeValue {
+public:
+    size_t Size() const override { return size_; }
+    size_t ReadChunk(size_t offset, uint8_t* out, size_t size) const override;
+
+protected:
+    // `cache` may be null, in which case every read goes to the source.
+    // Handles with the same `identity` share their cached chunks.
+    CachedLargeValue(size_t size, const ValueIdentity& identity, std::shared_ptr<ChunkCache> cache);
+
+    // Replace `out` with chunk `index`: kValueChunkSize bytes, fewer for
+    // the last one
+    virtual bool LoadChunk(size_t index, std::vector<uint8_t>& out) const = 0;
+
+    // Add a chunk to the cache, for sources that can only load the whole
+    // value and want to keep more than the requested chunk
+    void StoreChunk(size_t index, std::vector<uint8_t> data) const;
+
+    // Budget of the cache, or 0 without one
+    size_t CacheBudget() const;
+
+private:
+    size_t size_;
+    ValueIdentity identity_;
+    std::shared_ptr<ChunkCache> cache_;
+};
+
+} // namespace registry
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "registry_manager.h"
+
+namespace registry {
+
+// Map between raw registry type codes (the REG_* numbers stored by
+// Windows and in hive files) and ValueType
+ValueType ValueTypeFromRaw(uint32_t raw);
+uint32_t ValueTypeToRaw(ValueType type);
+
+// Raw type code to store for `value`: its rawType if the type is UNKNOWN
+uint32_t RawValueType(const Value& value);
+
+// Decode raw value bytes into `out`, reusing its storage where possible.
+// String data is UTF-16LE; REG_NONE and unmapped types keep their bytes. Never reads past `size`: odd byte counts,
+// missing terminators and short numeric payloads are all accepted, so the
+// decoder is safe to feed arbitrary input.
+void DecodeValueData(ValueType type, const uint8_t* data, size_t size, ValueData& out);
+ValueData DecodeValueData(ValueType type, const uint8_t* data, size_t size);
+
+// Encode a value into the raw bytes Windows stores for it (the inverse of
+// DecodeValueData). Returns false if the data does not match the type, or
+// for large values, whose data is not in memory.
+bool EncodeValueData(const Value& value, std::vector<uint8_t>& out);
+
+} // namespace registry
@@ -15,6 +15,14 @@ public:
     WindowsRegistryManager();
     ~WindowsRegistryManager();
 
+    using RegistryManager::OpenKey;
+    using RegistryManager::GetValues;
+    using RegistryManager::GetSubkeys;
+    using RegistryManager::CreateKey;
+    using RegistryManager::DeleteKey;
+    using RegistryManager::SetValue;
+    using RegistryManager::DeleteValue;
+
     std::optional<Key> OpenKey(const std::string& path) override;
     std::vector<Value> GetValues(const std::string& path) override;
     std::vector<std::string> GetSubkeys(const std::string& path) override;
@@ -27,9 +35,9 @@ private:
     // Helper methods
     HKEY GetRootKeyHandle(const std::string& rootKeyName);
     std::pair<HKEY, std::string> ParseRegistryPath(const std::string& path);
+    HKEY OpenKeyHandle(const std::string& path, REGSAM access);
+    void EnumerateSubkeys(HKEY hKey, DWORD begin, DWORD end, DWORD maxNameLength, std::vector<std::string>& out);
     ValueType GetValueType(DWORD winType);
-    DWORD GetWinType(ValueType type);
-    ValueData ReadValueData(HKEY hKey, const std::string& valueName, ValueType type);
 };
 
 } // namespace registry
@@ -0,0 +1,412 @@
+#include "fleet_compare.h"
+#include "text_encoding.h"
+#include "value_cache.h"
+#include "value_codec.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace registry {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+// Machine names listed per variant and differences listed per outlier
+constexpr size_t kMaxListedMachines = 10;
+constexpr size_t kMaxListedDifferences = 20;
+
+bool SameName(const std::string& a, const std::string& b) {
+    return a == b || FoldCase(a) == FoldCase(b);
+}
+
+void HashBytes(uint64_t& hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+}
+
+void HashU64(uint64_t& hash, uint64_t value) {
+    HashBytes(hash, &value, sizeof(value));
+}
+
+// Length-prefixed so that adjacent strings cannot run together
+void HashString(uint64_t& hash, const std::string& text) {
+    HashU64(hash, text.size());
+    HashBytes(hash, text.data(), text.size());
+}
+
+uint64_t HashValue(const Value& value) {
+    uint64_t hash = kFnvOffset;
+    HashString(hash, FoldCase(value.name));
+    HashU64(hash, static_cast<uint64_t>(value.type));
+    HashU64(hash, RawValueType(value));
+    HashU64(hash, value.data.index());
+    std::visit([&hash](const auto& data) {
+        using T = std::decay_t<decltype(data)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+            HashString(hash, data);
+        } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
+            HashU64(hash, data.size());
+            HashBytes(hash, data.data(), data.size());
+        } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+            HashU64(hash, data.size());
+            for (const auto& item : data) {
+                HashString(hash, item);
+            }
+        } else if constexpr (!std::is_same_v<T, std::monostate>) {
+            HashU64(hash, data);
+        }
+    }, value.data);
+
+    // Large values are hashed a chunk at a time, never held whole
+    if (value.large) {
+        std::vector<uint8_t> chunk(kValueChunkSize);
+        size_t size = value.large->Size();
+        HashU64(hash, size);
+        for (size_t offset = 0; offset < size;) {
+            size_t read = value.large->ReadChunk(offset, chunk.data(), std::min(chunk.size(), size - offset));
+            if (read == 0) {
+                break;
+            }
+            HashBytes(hash, chunk.data(), read);
+            offset += read;
+        }
+    }
+    return hash;
+}
+
+// Stands in for a large value once its contents are hashed. Only the size
+// is kept, so the pool holds nothing of a source that may since be closed.
+class DetachedLargeValue : public LargeValue {
+public:
+    explicit DetachedLargeValue(size_t size) : size_(size) {}
+
+    size_t Size() const override { return size_; }
+    size_t ReadChunk(size_t, uint8_t*, size_t) const override { return 0; }
+
+private:
+    size_t size_;
+};
+
+// Shared store of distinct values. Interning makes equal values share one
+// object, so snapshots compare value by value with a pointer check. Large
+// values are matched by size and content hash, since their source may be
+// closed by the time another machine is compared against them; the report
+// says so.
+class ValuePool {
+public:
+    std::shared_ptr<const Value> Intern(Value&& value, uint64_t& hash) {
+        hash = HashValue(value);
+        if (value.large) {
+            value.large = std::make_shared<DetachedLargeValue>(value.large->Size());
+            hashed_large_values_ = true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& bucket = values_[hash];
+        for (const auto& existing : bucket) {
+            bool sameLarge = existing->large && value.large ? existing->large->Size() == value.large->Size()
+                                                            : !existing->large && !value.large;
+            if (existing->type == value.type && RawValueType(*existing) == RawValueType(value) &&
+                existing->data == value.data && sameLarge &&
+                SameName(existing->name, value.name)) {
+                return existing;
+            }
+        }
+        bucket.push_back(std::make_shared<const Value>(std::move(value)));
+        return bucket.back();
+    }
+
+    bool HashedLargeValues() const { return hashed_large_values_; }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<const Value>>> values_;
+    std::atomic<bool> hashed_large_values_{false};
+};
+
+// Append `key` and everything below it to `out` in canonical order
+void WalkSubtree(RegistryManager& manager, const std::string& root, const std::string& relative,
+                 Key& key, ValuePool& pool, SubtreeSnapshot& out, uint64_t& hash) {
+    auto byName = [](const std::string& a, const std::string& b) {
+        return FoldCase(a) < FoldCase(b);
+    };
+
+    std::sort(key.values.begin(), key.values.end(), [&](const Value& a, const Value& b) {
+        return byName(a.name, b.name);
+    });
+
+    SnapshotKey entry;
+    entry.path = relative;
+    entry.values.reserve(key.values.size());
+    HashString(hash, FoldCase(relative));
+    HashU64(hash, key.values.size());
+    for (auto& value : key.values) {
+        uint64_t valueHash = 0;
+        entry.values.push_back(pool.Intern(std::move(value), valueHash));
+        HashU64(hash, valueHash);
+    }
+    out.push_back(std::move(entry));
+
+    std::sort(key.subkeys.begin(), key.subkeys.end(), byName);
+    for (const auto& subkey : key.subkeys) {
+        std::string childRelative = relative.empty() ? subkey : relative + "\\" + subkey;
+        std::string childPath = root.empty() ? childRelative : root + "\\" + childRelative;
+        auto child = manager.OpenKey(childPath);
+        if (!child) {
+            // Deleted while walking, or not readable
+            continue;
+        }
+        WalkSubtree(manager, root, childRelative, *child, pool, out, hash);
+    }
+}
+
+bool SameSnapshot(const SubtreeSnapshot& a, const SubtreeSnapshot& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].values != b[i].values || !SameName(a[i].path, b[i].path)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Machines grouped by subtree content for one path, filled in by workers
+struct PathGroups {
+    struct Group {
+        uint64_t hash;
+        std::shared_ptr<const SubtreeSnapshot> snapshot;
+        std::vector<size_t> machines;
+    };
+
+    std::mutex mutex;
+    std::vector<Group> groups;
+    std::vector<size_t> missing;
+
+    void Add(size_t machine, uint64_t hash, SubtreeSnapshot&& snapshot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& group : groups) {
+            if (group.hash == hash && SameSnapshot(*group.snapshot, snapshot)) {
+                group.machines.push_back(machine);
+                return;
+            }
+        }
+        groups.push_back({hash, std::make_shared<const SubtreeSnapshot>(std::move(snapshot)), {machine}});
+    }
+};
+
+std::string ValueLabel(const std::string& keyPath, const Value& value) {
+    std::string name = value.name.empty() ? "(Default)" : value.name;
+    return keyPath.empty() ? name : keyPath + "\\" + name;
+}
+
+std::string ValueText(const Value& value) {
+    // Unmapped types are told apart by their raw code
+    std::string type = RegistryManager::ValueTypeToString(value.type);
+    if (value.type == ValueType::UNKNOWN) {
+        type += "(" + std::to_string(value.rawType) + ")";
+    }
+    return type + " " + RegistryManager::ValueDataToString(value);
+}
+
+std::string MachineList(const std::vector<std::string>& machines) {
+    std::string result;
+    for (size_t i = 0; i < machines.size() && i < kMaxListedMachines; ++i) {
+        result += (i == 0 ? "" : ", ") + machines[i];
+    }
+    if (machines.size() > kMaxListedMachines) {
+        result += " and " + std::to_string(machines.size() - kMaxListedMachines) + " more";
+    }
+    return result;
+}
+
+// Differences that turn `baseline` into `variant`, one line each
+std::vector<std::string> DiffSnapshots(const SubtreeSnapshot& baseline, const SubtreeSnapshot& variant) {
+    std::map<std::string, std::pair<const SnapshotKey*, const SnapshotKey*>> keys;
+    for (const auto& key : baseline) {
+        keys[FoldCase(key.path)].first = &key;
+    }
+    for (const auto& key : variant) {
+        keys[FoldCase(key.path)].second = &key;
+    }
+
+    std::vector<std::string> lines;
+    for (const auto& [folded, pair] : keys) {
+        const auto [before, after] = pair;
+        if (!after) {
+            lines.push_back("- key " + (before->path.empty() ? std::string("(root)") : before->path));
+            continue;
+        }
+        if (!before) {
+            lines.push_back("+ key " + (after->path.empty() ? std::string("(root)") : after->path));
+        }
+
+        std::map<std::string, std::pair<const Value*, const Value*>> values;
+        if (before) {
+            for (const auto& value : before->values) {
+                values[FoldCase(value->name)].first = value.get();
+            }
+        }
+        for (const auto& value : after->values) {
+            values[FoldCase(value->name)].second = value.get();
+        }
+        for (const auto& [name, change] : values) {
+            const auto [oldValue, newValue] = change;
+            if (oldValue == newValue) {
+                continue;
+            }
+            if (!newValue) {
+                lines.push_back("- " + ValueLabel(after->path, *oldValue));
+            } else if (!oldValue) {
+                lines.push_back("+ " + ValueLabel(after->path, *newValue) + " = " + ValueText(*newValue));
+            } else {
+                lines.push_back("~ " + ValueLabel(after->path, *newValue) + ": " +
+                                ValueText(*oldValue) + " -> " + ValueText(*newValue));
+            }
+        }
+    }
+    return lines;
+}
+
+} // namespace
+
+FleetReport CompareFleet(const std::vector<FleetSource>& sources,
+                         const std::vector<std::string>& paths,
+                         unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(sources.size(), 1)));
+
+    ValuePool pool;
+    std::vector<PathGroups> results(paths.size());
+    std::vector<size_t> unavailable;
+    std::mutex unavailableMutex;
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        for (size_t machine = next++; machine < sources.size(); machine = next++) {
+            std::unique_ptr<RegistryManager> manager = sources[machine].open ? sources[machine].open() : nullptr;
+            if (!manager) {
+                std::lock_guard<std::mutex> lock(unavailableMutex);
+                unavailable.push_back(machine);
+                continue;
+            }
+
+            for (size_t i = 0; i < paths.size(); ++i) {
+                auto root = manager->OpenKey(paths[i]);
+                if (!root) {
+                    std::lock_guard<std::mutex> lock(results[i].mutex);
+                    results[i].missing.push_back(machine);
+                    continue;
+                }
+
+                SubtreeSnapshot snapshot;
+                uint64_t hash = kFnvOffset;
+                WalkSubtree(*manager, paths[i], "", *root, pool, snapshot, hash);
+                results[i].Add(machine, hash, std::move(snapshot));
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    // Order everything by source index so the report is deterministic
+    auto names = [&sources](std::vector<size_t>& machines) {
+        std::sort(machines.begin(), machines.end());
+        std::vector<std::string> result;
+        for (size_t machine : machines) {
+            result.push_back(sources[machine].name);
+        }
+        return result;
+    };
+
+    FleetReport report;
+    report.unavailable = names(unavailable);
+    report.largeValuesHashed = pool.HashedLargeValues();
+    for (size_t i = 0; i < paths.size(); ++i) {
+        auto& groups = results[i].groups;
+        for (auto& group : groups) {
+            std::sort(group.machines.begin(), group.machines.end());
+        }
+        std::sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) {
+            if (a.machines.size() != b.machines.size()) {
+                return a.machines.size() > b.machines.size();
+            }
+            return a.machines.front() < b.machines.front();
+        });
+
+        SubtreeComparison comparison;
+        comparison.path = paths[i];
+        comparison.missing = names(results[i].missing);
+        for (auto& group : groups) {
+            SubtreeVariant variant;
+            variant.hash = group.hash;
+            variant.machines = names(group.machines);
+            variant.snapshot = std::move(group.snapshot);
+            comparison.variants.push_back(std::move(variant));
+        }
+        report.subtrees.push_back(std::move(comparison));
+    }
+    return report;
+}
+
+std::string FormatFleetReport(const FleetReport& report) {
+    std::string text;
+    if (!report.unavailable.empty()) {
+        text += "Unavailable (" + std::to_string(report.unavailable.size()) + "): " +
+                MachineList(report.unavailable) + "\n\n";
+    }
+
+    for (const auto& subtree : report.subtrees) {
+        text += subtree.path + ": " + std::to_string(subtree.variants.size()) +
+                (subtree.variants.size() == 1 ? " variant\n" : " variants\n");
+
+        for (size_t i = 0; i < subtree.variants.size(); ++i) {
+            const auto& variant = subtree.variants[i];
+            text += "  Variant " + std::to_string(i + 1) + " (" + std::to_string(variant.machines.size()) +
+                    (variant.machines.size() == 1 ? " machine" : " machines") + (i == 0 ? "): " : ", outlier): ") +
+                    MachineList(variant.machines) + "\n";
+            if (i == 0) {
+                continue;
+            }
+
+            std::vector<std::string> lines = DiffSnapshots(*subtree.variants[0].snapshot, *variant.snapshot);
+            for (size_t j = 0; j < lines.size() && j < kMaxListedDifferences; ++j) {
+                text += "    " + lines[j] + "\n";
+            }
+            if (lines.size() > kMaxListedDifferences) {
+                text += "    ... and " + std::to_string(lines.size() - kMaxListedDifferences) + " more differences\n";
+            }
+        }
+
+        if (!subtree.missing.empty()) {
+            text += "  Missing (" + std::to_string(subtree.missing.size()) + "): " +
+                    MachineList(subtree.missing) + "\n";
+        }
+        text += "\n";
+    }
+
+    if (report.largeValuesHashed) {
+        text += "Note: large values were compared by size and a 64-bit content hash, not byte by byte.\n";
+    }
+    return text;
+}
+
+} // namespace registry
@@ -0,0 +1,744 @@
+#include "hive_image.h"
+#include "hive_log.h"
+#include "hive_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+#ifdef PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include "text_encoding.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace registry {
+
+using namespace hive;
+
+namespace {
+
+std::atomic<uint64_t> next_image_id{1};
+
+} // namespace
+
+// Read-only memory mapping of a file, with positional writes that bypass
+// the mapping
+class MappedFile {
+public:
+    ~MappedFile();
+
+    bool Open(const std::string& path);
+    const uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+    bool WriteAt(uint64_t offset, const void* data, size_t size);
+    bool Flush();
+
+    // Bytes of the mapping currently in memory
+    size_t ResidentBytes() const;
+
+    // Whether `path` names the mapped file itself (through any link)
+    bool IsSameFile(const std::string& path) const;
+
+private:
+    bool OpenWriter();
+
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef PLATFORM_WINDOWS
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = NULL;
+    HANDLE writer_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+    int writer_ = -1;
+#endif
+};
+
+#ifdef PLATFORM_WINDOWS
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != NULL) {
+        CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+    }
+    if (writer_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(writer_);
+    }
+}
+
+bool MappedFile::Open(const std::string& path) {
+    path_ = path;
+    std::u16string widePath;
+    Utf8ToUtf16(path, widePath);
+
+    file_ = CreateFileW(reinterpret_cast<const wchar_t*>(widePath.c_str()), GENERIC_READ,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0) {
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    mapping_ = CreateFileMappingW(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_ == NULL) {
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    return data_ != nullptr;
+}
+
+bool MappedFile::OpenWriter() {
+    if (writer_ != INVALID_HANDLE_VALUE) {
+        return true;
+    }
+    std::u16string widePath;
+    Utf8ToUtf16(path_, widePath);
+    writer_ = CreateFileW(reinterpret_cast<const wchar_t*>(widePath.c_str()), GENERIC_WRITE,
+                          FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL, NULL);
+    return writer_ != INVALID_HANDLE_VALUE;
+}
+
+bool MappedFile::WriteAt(uint64_t offset, const void* data, size_t size) {
+    if (!OpenWriter()) {
+        return false;
+    }
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD written = 0;
+    return WriteFile(writer_, data, static_cast<DWORD>(size), &written, &overlapped) && written == size;
+}
+
+bool MappedFile::Flush() {
+    return writer_ == INVALID_HANDLE_VALUE || FlushFileBuffers(writer_);
+}
+
+size_t MappedFile::ResidentBytes() const {
+    // Residency of a view is not cheaply queryable here; assume all of it
+    return size_;
+}
+
+bool MappedFile::IsSameFile(const std::string& path) const {
+    std::u16string widePath;
+    Utf8ToUtf16(path, widePath);
+    HANDLE other = CreateFileW(reinterpret_cast<const wchar_t*>(widePath.c_str()), 0,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (other == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION mine;
+    BY_HANDLE_FILE_INFORMATION theirs;
+    bool same = GetFileInformationByHandle(file_, &mine) && GetFileInformationByHandle(other, &theirs) &&
+                mine.dwVolumeSerialNumber == theirs.dwVolumeSerialNumber &&
+                mine.nFileIndexHigh == theirs.nFileIndexHigh && mine.nFileIndexLow == theirs.nFileIndexLow;
+    CloseHandle(other);
+    return same;
+}
+
+#else
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    if (writer_ >= 0) {
+        close(writer_);
+    }
+}
+
+bool MappedFile::Open(const std::string& path) {
+    path_ = path;
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size == 0) {
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapping);
+    return true;
+}
+
+bool MappedFile::OpenWriter() {
+    if (writer_ < 0) {
+        writer_ = open(path_.c_str(), O_WRONLY);
+    }
+    return writer_ >= 0;
+}
+
+bool MappedFile::WriteAt(uint64_t offset, const void* data, size_t size) {
+    if (!OpenWriter()) {
+        return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = pwrite(writer_, bytes, size, static_cast<off_t>(offset));
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        offset += static_cast<uint64_t>(written);
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool MappedFile::Flush() {
+    return writer_ < 0 || fsync(writer_) == 0;
+}
+
+size_t MappedFile::ResidentBytes() const {
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#ifdef PLATFORM_MACOS
+    std::vector<char> residency((size_ + pageSize - 1) / pageSize);
+#else
+    std::vector<unsigned char> residency((size_ + pageSize - 1) / pageSize);
+#endif
+    if (mincore(const_cast<uint8_t*>(data_), size_, residency.data()) != 0) {
+        return size_;
+    }
+    size_t resident = 0;
+    for (auto page : residency) {
+        resident += (page & 1) ? pageSize : 0;
+    }
+    return resident;
+}
+
+bool MappedFile::IsSameFile(const std::string& path) const {
+    struct stat mine;
+    struct stat theirs;
+    return fstat(fd_, &mine) == 0 && stat(path.c_str(), &theirs) == 0 &&
+           mine.st_dev == theirs.st_dev && mine.st_ino == theirs.st_ino;
+}
+
+#endif
+
+namespace {
+
+uint32_t RoundUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Bytes of bins scanned for free cells per allocation before the hive is
+// grown instead
+constexpr uint32_t kScanBudget = 1024 * 1024;
+
+} // namespace
+
+HiveImage::~HiveImage() = default;
+
+std::unique_ptr<HiveImage> HiveImage::Open(const std::string& path) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->Open(path) || file->Size() < kBaseBlockSize) {
+        return nullptr;
+    }
+    if (LoadU32(file->Data()) != kBaseSignature) {
+        return nullptr;
+    }
+
+    std::unique_ptr<HiveImage> image(new HiveImage());
+    image->path_ = path;
+    image->id_ = next_image_id++;
+    image->base_block_.assign(file->Data(), file->Data() + kBaseBlockSize);
+    image->file_ = std::move(file);
+    return image;
+}
+
+uint32_t HiveImage::RootCell() const {
+    return LoadU32(base_block_.data() + kBaseRootCell);
+}
+
+uint32_t HiveImage::BinsSize() const {
+    return LoadU32(base_block_.data() + kBaseBinsSize);
+}
+
+uint32_t HiveImage::MinorVersion() const {
+    return LoadU32(base_block_.data() + kBaseMinorVersion);
+}
+
+bool HiveImage::IsDirty() const {
+    return LoadU32(base_block_.data() + kBasePrimarySequence) !=
+           LoadU32(base_block_.data() + kBaseSecondarySequence);
+}
+
+const uint8_t* HiveImage::PageData(uint32_t page) const {
+    auto it = pages_.find(page);
+    if (it != pages_.end()) {
+        return it->second.data();
+    }
+    uint64_t fileOffset = kBaseBlockSize + static_cast<uint64_t>(page) * kPageSize;
+    if (fileOffset + kPageSize > file_->Size()) {
+        return nullptr;
+    }
+    return file_->Data() + fileOffset;
+}
+
+uint8_t* HiveImage::MutablePage(uint32_t page) {
+    auto it = pages_.find(page);
+    if (it == pages_.end()) {
+        const uint8_t* base = PageData(page);
+        std::vector<uint8_t> copy(kPageSize, 0);
+        if (base != nullptr) {
+            std::memcpy(copy.data(), base, kPageSize);
+        }
+        it = pages_.emplace(page, std::move(copy)).first;
+    }
+    return it->second.data();
+}
+
+bool HiveImage::Read(uint32_t offset, void* out, size_t size) const {
+    if (static_cast<uint64_t>(offset) + size > BinsSize()) {
+        return false;
+    }
+    uint8_t* dst = static_cast<uint8_t*>(out);
+    while (size > 0) {
+        uint32_t page = offset / kPageSize;
+        uint32_t inPage = offset % kPageSize;
+        size_t chunk = std::min<size_t>(size, kPageSize - inPage);
+        const uint8_t* src = PageData(page);
+        if (src == nullptr) {
+            return false;
+        }
+        std::memcpy(dst, src + inPage, chunk);
+        dst += chunk;
+        offset += static_cast<uint32_t>(chunk);
+        size -= chunk;
+    }
+    return true;
+}
+
+bool HiveImage::Write(uint32_t offset, const void* data, size_t size) {
+    if (static_cast<uint64_t>(offset) + size > BinsSize()) {
+        return false;
+    }
+    ++generation_;
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        uint32_t page = offset / kPageSize;
+        uint32_t inPage = offset % kPageSize;
+        size_t chunk = std::min<size_t>(size, kPageSize - inPage);
+        std::memcpy(MutablePage(page) + inPage, src, chunk);
+        dirty_pages_.insert(page);
+        src += chunk;
+        offset += static_cast<uint32_t>(chunk);
+        size -= chunk;
+    }
+    return true;
+}
+
+bool HiveImage::Recover(const std::vector<std::string>& logPaths) {
+    if (!IsDirty()) {
+        return false;
+    }
+
+    std::vector<std::unique_ptr<HiveLog>> logs;
+    for (const auto& logPath : logPaths) {
+        if (auto log = HiveLog::Read(logPath)) {
+            logs.push_back(std::move(log));
+        }
+    }
+    std::sort(logs.begin(), logs.end(), [](const auto& a, const auto& b) {
+        return a->Sequence() < b->Sequence();
+    });
+
+    // Replay has to continue exactly where the primary file's last complete
+    // write left off: new-format entries from its secondary sequence number
+    // (lower ones were already written to it), an old-format log from the
+    // primary sequence number of the write it interrupted. Replaying across
+    // a gap would mix pages from unrelated states.
+    uint32_t primary = LoadU32(base_block_.data() + kBasePrimarySequence);
+    uint32_t secondary = LoadU32(base_block_.data() + kBaseSecondarySequence);
+    bool applied = false;
+    uint32_t sequence = 0;
+    uint32_t rootCell = RootCell();
+
+    for (const auto& log : logs) {
+        bool gap = false;
+        uint32_t first = log->IsNewFormat() ? secondary : primary;
+        for (const auto& entry : log->Entries()) {
+            if (applied ? entry.sequence <= sequence : entry.sequence < first) {
+                continue;
+            }
+            if (entry.sequence != (applied ? sequence + 1 : first)) {
+                gap = true;
+                break;
+            }
+
+            StoreU32(base_block_.data() + kBaseBinsSize, entry.binsSize);
+            for (const auto& page : entry.pages) {
+                ApplyRecovered(page.offset, page.data, page.size);
+            }
+            applied = true;
+            sequence = entry.sequence;
+            rootCell = log->RootCell();
+        }
+        if (gap) {
+            break;
+        }
+    }
+
+    if (!applied) {
+        return false;
+    }
+
+    StoreU32(base_block_.data() + kBasePrimarySequence, sequence);
+    StoreU32(base_block_.data() + kBaseSecondarySequence, sequence);
+    StoreU32(base_block_.data() + kBaseRootCell, rootCell);
+    recovered_ = true;
+    return true;
+}
+
+void HiveImage::ApplyRecovered(uint32_t offset, const uint8_t* data, uint32_t size) {
+    while (size > 0) {
+        uint32_t page = offset / kPageSize;
+        uint32_t inPage = offset % kPageSize;
+        uint32_t chunk = std::min(size, kPageSize - inPage);
+        std::memcpy(MutablePage(page) + inPage, data, chunk);
+        recovered_pages_.insert(page);
+        data += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+uint16_t HiveImage::ReadU16(uint32_t offset) const {
+    uint8_t bytes[2] = {0, 0};
+    Read(offset, bytes, sizeof(bytes));
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t HiveImage::ReadU32(uint32_t offset) const {
+    uint8_t bytes[4] = {0, 0, 0, 0};
+    Read(offset, bytes, sizeof(bytes));
+    return LoadU32(bytes);
+}
+
+bool HiveImage::WriteU16(uint32_t offset, uint16_t value) {
+    uint8_t bytes[2] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8)};
+    return Write(offset, bytes, sizeof(bytes));
+}
+
+bool HiveImage::WriteU32(uint32_t offset, uint32_t value) {
+    uint8_t bytes[4];
+    StoreU32(bytes, value);
+    return Write(offset, bytes, sizeof(bytes));
+}
+
+uint32_t HiveImage::CellCapacity(uint32_t cell) const {
+    if (cell == kNoCell || static_cast<uint64_t>(cell) + 4 > BinsSize()) {
+        return 0;
+    }
+    int32_t size = static_cast<int32_t>(ReadU32(cell));
+    if (size >= 0 || size == INT32_MIN) {
+        return 0;
+    }
+    uint32_t total = static_cast<uint32_t>(-size);
+    if (total < 4 || static_cast<uint64_t>(cell) + total > BinsSize()) {
+        return 0;
+    }
+    return total - 4;
+}
+
+bool HiveImage::ReadCell(uint32_t cell, std::vector<uint8_t>& out) const {
+    uint32_t capacity = CellCapacity(cell);
+    if (capacity == 0) {
+        out.clear();
+        return false;
+    }
+    out.resize(capacity);
+    return Read(cell + 4, out.data(), capacity);
+}
+
+bool HiveImage::FindBin(uint32_t offset, uint32_t& binOffset, uint32_t& binSize) const {
+    // Bins start on page boundaries; walk back to the header covering `offset`
+    for (int64_t page = offset / kPageSize; page >= 0; --page) {
+        uint32_t candidate = static_cast<uint32_t>(page) * kPageSize;
+        if (ReadU32(candidate) != kBinSignature || ReadU32(candidate + kBinOffset) != candidate) {
+            continue;
+        }
+        uint32_t size = ReadU32(candidate + kBinSize);
+        if (static_cast<uint64_t>(candidate) + size <= offset) {
+            return false;
+        }
+        binOffset = candidate;
+        binSize = size;
+        return true;
+    }
+    return false;
+}
+
+bool HiveImage::ScanNextBin() {
+    uint32_t binOffset = scan_cursor_;
+    if (binOffset >= BinsSize()) {
+        return false;
+    }
+
+    uint32_t binSize = ReadU32(binOffset + kBinSize);
+    if (ReadU32(binOffset) != kBinSignature || binSize < kPageSize || binSize % kPageSize != 0 ||
+        static_cast<uint64_t>(binOffset) + binSize > BinsSize()) {
+        // Corrupt bin chain: stop reusing space rather than guess
+        scan_cursor_ = BinsSize();
+        return false;
+    }
+
+    uint32_t end = binOffset + binSize;
+    uint32_t offset = binOffset + kBinHeaderSize;
+    while (offset + 4 <= end) {
+        int32_t size = static_cast<int32_t>(ReadU32(offset));
+        uint32_t length = size < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(size))
+                                   : static_cast<uint32_t>(size);
+        if (length < 8 || length % 8 != 0 || static_cast<uint64_t>(offset) + length > end) {
+            break;
+        }
+        if (size > 0) {
+            free_cells_.emplace(length, offset);
+        }
+        offset += length;
+    }
+
+    scan_cursor_ = end;
+    return true;
+}
+
+uint32_t HiveImage::AppendBin(uint32_t cellSize) {
+    uint32_t binOffset = BinsSize();
+    uint32_t binSize = RoundUp(cellSize + kBinHeaderSize, kPageSize);
+    if (static_cast<uint64_t>(binOffset) + binSize > 0x7FFFFFFF) {
+        return kNoCell;
+    }
+
+    StoreU32(base_block_.data() + kBaseBinsSize, binOffset + binSize);
+    base_block_dirty_ = true;
+
+    uint8_t header[kBinHeaderSize] = {};
+    StoreU32(header, kBinSignature);
+    StoreU32(header + kBinOffset, binOffset);
+    StoreU32(header + kBinSize, binSize);
+    uint64_t now = CurrentFileTime();
+    StoreU32(header + kBinTimestamp, static_cast<uint32_t>(now));
+    StoreU32(header + kBinTimestamp + 4, static_cast<uint32_t>(now >> 32));
+    Write(binOffset, header, sizeof(header));
+
+    // The whole bin body starts out as one free cell
+    uint32_t cell = binOffset + kBinHeaderSize;
+    WriteU32(cell, binSize - kBinHeaderSize);
+    if (scan_cursor_ == binOffset) {
+        scan_cursor_ = binOffset + binSize;
+    }
+    return cell;
+}
+
+uint32_t HiveImage::AllocateCell(uint32_t size) {
+    if (size > 0x7FFFFFF0) {
+        return kNoCell;
+    }
+    uint32_t needed = RoundUp(size + 4, 8);
+
+    uint32_t cell = kNoCell;
+    uint32_t cellSize = 0;
+    bool indexed = true;
+
+    uint32_t scanStart = scan_cursor_;
+    for (;;) {
+        auto it = free_cells_.lower_bound({needed, 0});
+        if (it != free_cells_.end()) {
+            cellSize = it->first;
+            cell = it->second;
+            free_cells_.erase(it);
+            break;
+        }
+        if (scan_cursor_ - scanStart >= kScanBudget || !ScanNextBin()) {
+            bool fullyScanned = scan_cursor_ >= BinsSize();
+            cell = AppendBin(needed);
+            if (cell == kNoCell) {
+                return kNoCell;
+            }
+            cellSize = static_cast<uint32_t>(ReadU32(cell));
+            indexed = fullyScanned;
+            break;
+        }
+    }
+
+    // Split off the remainder as a new free cell
+    if (cellSize - needed >= 8) {
+        uint32_t remainder = cell + needed;
+        WriteU32(remainder, cellSize - needed);
+        if (indexed) {
+            free_cells_.emplace(cellSize - needed, remainder);
+        }
+        cellSize = needed;
+    }
+
+    WriteU32(cell, static_cast<uint32_t>(-static_cast<int32_t>(cellSize)));
+    return cell;
+}
+
+void HiveImage::FreeCell(uint32_t cell) {
+    if (CellCapacity(cell) == 0) {
+        return;
+    }
+    uint32_t size = CellCapacity(cell) + 4;
+
+    uint32_t binOffset;
+    uint32_t binSize;
+    if (FindBin(cell, binOffset, binSize)) {
+        uint32_t end = binOffset + binSize;
+        uint32_t next = cell + size;
+        if (next + 4 <= end) {
+            int32_t nextSize = static_cast<int32_t>(ReadU32(next));
+            if (nextSize >= 8 && static_cast<uint64_t>(next) + nextSize <= end) {
+                free_cells_.erase({static_cast<uint32_t>(nextSize), next});
+                size += static_cast<uint32_t>(nextSize);
+            }
+        }
+
+        // Cells only record their own size, so the preceding cell is found
+        // by walking the bin up to this one
+        uint32_t previous = kNoCell;
+        uint32_t offset = binOffset + kBinHeaderSize;
+        while (offset < cell) {
+            int32_t cellSize = static_cast<int32_t>(ReadU32(offset));
+            uint32_t length = cellSize < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(cellSize))
+                                           : static_cast<uint32_t>(cellSize);
+            if (length < 8 || length % 8 != 0) {
+                break;
+            }
+            previous = cellSize > 0 ? offset : kNoCell;
+            offset += length;
+        }
+        if (offset == cell && previous != kNoCell) {
+            uint32_t previousSize = ReadU32(previous);
+            free_cells_.erase({previousSize, previous});
+            size += previousSize;
+            cell = previous;
+        }
+    }
+
+    WriteU32(cell, size);
+    if (cell < scan_cursor_) {
+        free_cells_.emplace(size, cell);
+    }
+}
+
+bool HiveImage::HasUnsavedChanges() const {
+    return base_block_dirty_ || !dirty_pages_.empty();
+}
+
+void HiveImage::UpdateBaseBlock(uint32_t primary, uint32_t secondary) {
+    uint8_t* block = base_block_.data();
+    StoreU32(block + kBasePrimarySequence, primary);
+    StoreU32(block + kBaseSecondarySequence, secondary);
+    uint64_t now = CurrentFileTime();
+    StoreU32(block + kBaseTimestamp, static_cast<uint32_t>(now));
+    StoreU32(block + kBaseTimestamp + 4, static_cast<uint32_t>(now >> 32));
+    StoreU32(block + kBaseChecksum, BaseBlockChecksum(block));
+}
+
+bool HiveImage::Save() {
+    if (!HasUnsavedChanges() && recovered_pages_.empty()) {
+        return true;
+    }
+
+    // Mirror the Windows write protocol: bump the primary sequence number
+    // first so an interrupted save leaves the hive marked dirty, then write
+    // the data, then make both sequence numbers match again.
+    uint32_t sequence = LoadU32(base_block_.data() + kBasePrimarySequence) + 1;
+    uint32_t previous = LoadU32(base_block_.data() + kBaseSecondarySequence);
+    UpdateBaseBlock(sequence, previous);
+    if (!file_->WriteAt(0, base_block_.data(), kBaseBlockSize) || !file_->Flush()) {
+        return false;
+    }
+
+    std::set<uint32_t> pages = dirty_pages_;
+    pages.insert(recovered_pages_.begin(), recovered_pages_.end());
+    for (uint32_t page : pages) {
+        uint64_t fileOffset = kBaseBlockSize + static_cast<uint64_t>(page) * kPageSize;
+        if (!file_->WriteAt(fileOffset, pages_[page].data(), kPageSize)) {
+            return false;
+        }
+    }
+    if (!file_->Flush()) {
+        return false;
+    }
+
+    UpdateBaseBlock(sequence, sequence);
+    if (!file_->WriteAt(0, base_block_.data(), kBaseBlockSize) || !file_->Flush()) {
+        return false;
+    }
+
+    dirty_pages_.clear();
+    recovered_pages_.clear();
+    base_block_dirty_ = false;
+    return true;
+}
+
+bool HiveImage::SaveAs(const std::string& path) const {
+    // Truncating the mapped file would fault later reads of the mapping;
+    // Save() is the way to write it in place
+    if (file_->IsSameFile(path)) {
+        return false;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    std::vector<uint8_t> block = base_block_;
+    uint32_t sequence = LoadU32(block.data() + kBasePrimarySequence) + 1;
+    StoreU32(block.data() + kBasePrimarySequence, sequence);
+    StoreU32(block.data() + kBaseSecondarySequence, sequence);
+    StoreU32(block.data() + kBaseChecksum, BaseBlockChecksum(block.data()));
+    out.write(reinterpret_cast<const char*>(block.data()), kBaseBlockSize);
+
+    std::vector<uint8_t> page(kPageSize);
+    for (uint32_t offset = 0; offset < BinsSize(); offset += kPageSize) {
+        if (!Read(offset, page.data(), kPageSize)) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(page.data()), kPageSize);
+    }
+    return static_cast<bool>(out.flush());
+}
+
+size_t HiveImage::OverlayBytes() const {
+    return pages_.size() * kPageSize;
+}
+
+size_t HiveImage::ResidentBytes() const {
+    return file_->ResidentBytes();
+}
+
+} // namespace registry
@@ -0,0 +1,172 @@
+#include "hive_log.h"
+#include "hive_util.h"
+#include <fstream>
+#include <iterator>
+
+namespace registry {
+
+using namespace hive;
+
+namespace {
+
+uint32_t RotateLeft(uint32_t value, int shift) {
+    return (value << shift) | (value >> (32 - shift));
+}
+
+void MarvinBlock(uint32_t& lo, uint32_t& hi) {
+    hi ^= lo;
+    lo = RotateLeft(lo, 20);
+    lo += hi;
+    hi = RotateLeft(hi, 9);
+    hi ^= lo;
+    lo = RotateLeft(lo, 27);
+    lo += hi;
+    hi = RotateLeft(hi, 19);
+}
+
+} // namespace
+
+uint64_t Marvin32(const uint8_t* data, size_t size, uint64_t seed) {
+    uint32_t lo = static_cast<uint32_t>(seed);
+    uint32_t hi = static_cast<uint32_t>(seed >> 32);
+
+    for (; size >= 4; data += 4, size -= 4) {
+        lo += LoadU32(data);
+        MarvinBlock(lo, hi);
+    }
+
+    uint32_t last = 0x80;
+    for (size_t i = size; i > 0; --i) {
+        last = (last << 8) | data[i - 1];
+    }
+    lo += last;
+    MarvinBlock(lo, hi);
+    MarvinBlock(lo, hi);
+
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+std::unique_ptr<HiveLog> HiveLog::Read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+
+    std::unique_ptr<HiveLog> log(new HiveLog());
+    log->data_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    const std::vector<uint8_t>& data = log->data_;
+    if (data.size() < kLogSectorSize || LoadU32(data.data()) != kBaseSignature ||
+        BaseBlockChecksum(data.data()) != LoadU32(data.data() + kBaseChecksum)) {
+        return nullptr;
+    }
+
+    log->sequence_ = LoadU32(data.data() + kBasePrimarySequence);
+    log->root_cell_ = LoadU32(data.data() + kBaseRootCell);
+
+    uint32_t fileType = LoadU32(data.data() + kBaseFileType);
+    bool parsed = false;
+    if (fileType == kFileTypeLogNew) {
+        log->new_format_ = true;
+        parsed = log->ParseEntries();
+    } else if (fileType == kFileTypeLog || fileType == kFileTypeLogAlternate) {
+        // A log whose sequence numbers differ was itself torn mid-write
+        if (log->sequence_ == LoadU32(data.data() + kBaseSecondarySequence)) {
+            parsed = log->ParseDirtyVector(LoadU32(data.data() + kBaseBinsSize));
+        }
+    }
+
+    if (!parsed || log->entries_.empty()) {
+        return nullptr;
+    }
+    return log;
+}
+
+bool HiveLog::ParseDirtyVector(uint32_t binsSize) {
+    const uint8_t* base = data_.data();
+    size_t vectorBytes = binsSize / kLogSectorSize / 8;
+    size_t vectorEnd = kLogSectorSize + 4 + vectorBytes;
+    if (vectorEnd > data_.size() || LoadU32(base + kLogSectorSize) != kDirtyVectorSignature) {
+        return false;
+    }
+
+    Entry entry;
+    entry.sequence = sequence_;
+    entry.binsSize = binsSize;
+
+    // Dirty sectors follow the vector, starting on a sector boundary.
+    // Consecutive dirty sectors are coalesced into one range.
+    const uint8_t* bits = base + kLogSectorSize + 4;
+    size_t source = (vectorEnd + kLogSectorSize - 1) / kLogSectorSize * kLogSectorSize;
+    size_t sectors = vectorBytes * 8;
+    for (size_t sector = 0; sector < sectors; ++sector) {
+        if ((bits[sector / 8] & (1u << (sector % 8))) == 0) {
+            continue;
+        }
+        if (source + kLogSectorSize > data_.size()) {
+            return false;
+        }
+        uint32_t offset = static_cast<uint32_t>(sector * kLogSectorSize);
+        if (!entry.pages.empty() && entry.pages.back().offset + entry.pages.back().size == offset) {
+            entry.pages.back().size += kLogSectorSize;
+        } else {
+            entry.pages.push_back({offset, kLogSectorSize, base + source});
+        }
+        source += kLogSectorSize;
+    }
+
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+bool HiveLog::ParseEntries() {
+    const uint8_t* base = data_.data();
+    size_t offset = kLogSectorSize;
+
+    while (offset + kLogEntryPages <= data_.size()) {
+        const uint8_t* header = base + offset;
+        uint32_t size = LoadU32(header + kLogEntrySize);
+        if (LoadU32(header) != kLogEntrySignature || size < kLogEntryPages || size % kLogSectorSize != 0 ||
+            offset + size > data_.size()) {
+            break;
+        }
+
+        // Hash 1 covers everything after the header, hash 2 the first 32 bytes
+        if (Marvin32(header + kLogEntryPages, size - kLogEntryPages, kLogEntryHashSeed) !=
+                LoadU64(header + kLogEntryDataHash) ||
+            Marvin32(header, kLogEntryDataHash + 8, kLogEntryHashSeed) != LoadU64(header + kLogEntryHeaderHash)) {
+            break;
+        }
+
+        Entry entry;
+        entry.sequence = LoadU32(header + kLogEntrySequence);
+        entry.binsSize = LoadU32(header + kLogEntryBinsSize);
+        if (!entries_.empty() && entry.sequence != entries_.back().sequence + 1) {
+            break;
+        }
+
+        uint32_t pageCount = LoadU32(header + kLogEntryPageCount);
+        size_t references = kLogEntryPages;
+        size_t contents = references + static_cast<size_t>(pageCount) * 8;
+        bool valid = contents <= size;
+        for (uint32_t i = 0; valid && i < pageCount; ++i) {
+            uint32_t pageOffset = LoadU32(header + references + i * 8);
+            uint32_t pageSize = LoadU32(header + references + i * 8 + 4);
+            if (contents + pageSize > size || static_cast<uint64_t>(pageOffset) + pageSize > entry.binsSize) {
+                valid = false;
+                break;
+            }
+            entry.pages.push_back({pageOffset, pageSize, header + contents});
+            contents += pageSize;
+        }
+        if (!valid) {
+            break;
+        }
+
+        entries_.push_back(std::move(entry));
+        offset += size;
+    }
+    return true;
+}
+
+} // namespace registry
@@ -0,0 +1,1265 @@
+#include "hive_registry_manager.h"
+#include "hive_image.h"
+#include "hive_util.h"
+#include "text_encoding.h"
+#include "value_cache.h"
+#include "value_codec.h"
+#include <algorithm>
+#include <functional>
+
+namespace registry {
+
+using namespace hive;
+
+namespace {
+
+// Subkey lists longer than this are split into an index root (ri) of leaves
+constexpr size_t kMaxLeafEntries = 1024;
+
+// Index roots only ever point at leaves, so lists nest at most this deep
+constexpr int kMaxListDepth = 2;
+
+uint32_t Payload(uint32_t cell) {
+    return cell + 4;
+}
+
+// Names are stored either "compressed" (one byte per character) or as
+// UTF-16LE. Both are decoded to UTF-16 code units here.
+std::u16string DecodeName(const uint8_t* data, size_t size, bool compressed) {
+    std::u16string name;
+    if (compressed) {
+        name.assign(data, data + size);
+    } else {
+        name.resize(size / 2);
+        for (size_t i = 0; i < name.size(); ++i) {
+            name[i] = LoadU16(data + 2 * i);
+        }
+    }
+    return name;
+}
+
+// Encode a name for storage; returns true if it was stored compressed
+bool EncodeName(const std::u16string& name, std::vector<uint8_t>& out) {
+    bool compressed = std::all_of(name.begin(), name.end(), [](char16_t c) { return c < 0x80; });
+    out.clear();
+    for (char16_t c : name) {
+        out.push_back(static_cast<uint8_t>(c));
+        if (!compressed) {
+            out.push_back(static_cast<uint8_t>(c >> 8));
+        }
+    }
+    return compressed;
+}
+
+int CompareNames(const std::u16string& a, const std::u16string& b) {
+    size_t length = std::min(a.size(), b.size());
+    for (size_t i = 0; i < length; ++i) {
+        char16_t ca = UpcaseChar(a[i]);
+        char16_t cb = UpcaseChar(b[i]);
+        if (ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    if (a.size() == b.size()) {
+        return 0;
+    }
+    return a.size() < b.size() ? -1 : 1;
+}
+
+// Hash stored in lh leaves
+uint32_t NameHash(const std::u16string& name) {
+    uint32_t hash = 0;
+    for (char16_t c : name) {
+        hash = hash * 37 + UpcaseChar(c);
+    }
+    return hash;
+}
+
+// Hint stored in lf leaves: the first four characters of the name
+uint32_t NameHint(const std::u16string& name) {
+    uint8_t hint[4] = {0, 0, 0, 0};
+    for (size_t i = 0; i < 4 && i < name.size(); ++i) {
+        hint[i] = static_cast<uint8_t>(name[i]);
+    }
+    return LoadU32(hint);
+}
+
+std::vector<std::u16string> SplitPath(const std::string& path) {
+    std::vector<std::u16string> components;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('\\', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            components.emplace_back();
+            Utf8ToUtf16(path.data() + start, end - start, components.back());
+        }
+        start = end + 1;
+    }
+    return components;
+}
+
+// Parsed key node (nk) cell
+struct KeyNode {
+    uint16_t flags = 0;
+    uint32_t parent = kNoCell;
+    uint32_t subkeyCount = 0;
+    uint32_t subkeyList = kNoCell;
+    uint32_t valueCount = 0;
+    uint32_t valueList = kNoCell;
+    uint32_t security = kNoCell;
+    uint32_t className = kNoCell;
+    std::u16string name;
+};
+
+bool ReadKeyNode(const HiveImage& image, uint32_t cell, KeyNode& node) {
+    std::vector<uint8_t> payload;
+    if (!image.ReadCell(cell, payload) || payload.size() < kKeyName ||
+        LoadU16(payload.data()) != kKeyNodeSignature) {
+        return false;
+    }
+    const uint8_t* p = payload.data();
+    node.flags = LoadU16(p + kKeyFlags);
+    node.parent = LoadU32(p + kKeyParent);
+    node.subkeyCount = LoadU32(p + kKeySubkeyCount);
+    node.subkeyList = LoadU32(p + kKeySubkeyList);
+    node.valueCount = LoadU32(p + kKeyValueCount);
+    node.valueList = LoadU32(p + kKeyValueList);
+    node.security = LoadU32(p + kKeySecurity);
+    node.className = LoadU32(p + kKeyClassName);
+
+    size_t nameLength = std::min<size_t>(LoadU16(p + kKeyNameLength), payload.size() - kKeyName);
+    node.name = DecodeName(p + kKeyName, nameLength, (node.flags & kKeyFlagCompressedName) != 0);
+    return true;
+}
+
+// Parsed value (vk) cell
+struct ValueNode {
+    uint32_t dataSize = 0;
+    uint32_t dataOffset = kNoCell;
+    uint32_t type = 0;
+    std::u16string name;
+};
+
+bool ReadValueNode(const HiveImage& image, uint32_t cell, ValueNode& node) {
+    std::vector<uint8_t> payload;
+    if (!image.ReadCell(cell, payload) || payload.size() < kValueName ||
+        LoadU16(payload.data()) != kValueSignature) {
+        return false;
+    }
+    const uint8_t* p = payload.data();
+    node.dataSize = LoadU32(p + kValueDataSize);
+    node.dataOffset = LoadU32(p + kValueDataOffset);
+    node.type = LoadU32(p + kValueType);
+
+    size_t nameLength = std::min<size_t>(LoadU16(p + kValueNameLength), payload.size() - kValueName);
+    bool compressed = (LoadU16(p + kValueFlags) & kValueFlagCompressedName) != 0;
+    node.name = DecodeName(p + kValueName, nameLength, compressed);
+    return true;
+}
+
+// Visit every entry of a subkey list, descending through index roots.
+// The visitor gets the child cell and, for lh leaves, the stored name
+// hash; it returns false to stop early.
+using SubkeyVisitor = std::function<bool(uint32_t cell, const uint32_t* hash)>;
+
+bool VisitSubkeys(const HiveImage& image, uint32_t list, const SubkeyVisitor& visit, int depth = 0) {
+    std::vector<uint8_t> payload;
+    if (list == kNoCell || depth >= kMaxListDepth || !image.ReadCell(list, payload) ||
+        payload.size() < kListEntries) {
+        return true;
+    }
+
+    uint16_t signature = LoadU16(payload.data());
+    size_t count = LoadU16(payload.data() + kListCount);
+    size_t entrySize = (signature == kFastLeafSignature || signature == kHashLeafSignature) ? 8 : 4;
+    count = std::min(count, (payload.size() - kListEntries) / entrySize);
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* entry = payload.data() + kListEntries + i * entrySize;
+        uint32_t cell = LoadU32(entry);
+        if (signature == kIndexRootSignature) {
+            if (!VisitSubkeys(image, cell, visit, depth + 1)) {
+                return false;
+            }
+        } else if (signature == kHashLeafSignature) {
+            uint32_t hash = LoadU32(entry + 4);
+            if (!visit(cell, &hash)) {
+                return false;
+            }
+        } else if (signature == kFastLeafSignature || signature == kIndexLeafSignature) {
+            if (!visit(cell, nullptr)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void FreeSubkeyList(HiveImage& image, uint32_t list) {
+    std::vector<uint8_t> payload;
+    if (list == kNoCell || !image.ReadCell(list, payload) || payload.size() < kListEntries) {
+        return;
+    }
+    if (LoadU16(payload.data()) == kIndexRootSignature) {
+        size_t count = std::min<size_t>(LoadU16(payload.data() + kListCount), (payload.size() - kListEntries) / 4);
+        for (size_t i = 0; i < count; ++i) {
+            image.FreeCell(LoadU32(payload.data() + kListEntries + i * 4));
+        }
+    }
+    image.FreeCell(list);
+}
+
+// Write a leaf (lh, or lf for hives older than 1.5) for a sorted run of
+// children
+uint32_t WriteLeaf(HiveImage& image, const std::vector<std::pair<std::u16string, uint32_t>>& children,
+                   size_t begin, size_t end) {
+    bool hashed = image.MinorVersion() >= 5;
+    std::vector<uint8_t> payload(kListEntries + (end - begin) * 8);
+    StoreU16(payload.data(), hashed ? kHashLeafSignature : kFastLeafSignature);
+    StoreU16(payload.data() + kListCount, static_cast<uint16_t>(end - begin));
+    for (size_t i = begin; i < end; ++i) {
+        uint8_t* entry = payload.data() + kListEntries + (i - begin) * 8;
+        StoreU32(entry, children[i].second);
+        StoreU32(entry + 4, hashed ? NameHash(children[i].first) : NameHint(children[i].first));
+    }
+
+    uint32_t cell = image.AllocateCell(static_cast<uint32_t>(payload.size()));
+    if (cell != kNoCell) {
+        image.Write(Payload(cell), payload.data(), payload.size());
+    }
+    return cell;
+}
+
+// Write a subkey list for children sorted by name
+uint32_t WriteSubkeyList(HiveImage& image, const std::vector<std::pair<std::u16string, uint32_t>>& children) {
+    if (children.empty()) {
+        return kNoCell;
+    }
+    if (children.size() <= kMaxLeafEntries) {
+        return WriteLeaf(image, children, 0, children.size());
+    }
+
+    std::vector<uint32_t> leaves;
+    for (size_t begin = 0; begin < children.size(); begin += kMaxLeafEntries) {
+        uint32_t leaf = WriteLeaf(image, children, begin, std::min(children.size(), begin + kMaxLeafEntries));
+        if (leaf == kNoCell) {
+            for (uint32_t written : leaves) {
+                image.FreeCell(written);
+            }
+            return kNoCell;
+        }
+        leaves.push_back(leaf);
+    }
+
+    std::vector<uint8_t> payload(kListEntries + leaves.size() * 4);
+    StoreU16(payload.data(), kIndexRootSignature);
+    StoreU16(payload.data() + kListCount, static_cast<uint16_t>(leaves.size()));
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        StoreU32(payload.data() + kListEntries + i * 4, leaves[i]);
+    }
+    uint32_t root = image.AllocateCell(static_cast<uint32_t>(payload.size()));
+    if (root == kNoCell) {
+        for (uint32_t leaf : leaves) {
+            image.FreeCell(leaf);
+        }
+        return kNoCell;
+    }
+    image.Write(Payload(root), payload.data(), payload.size());
+    return root;
+}
+
+// A subkey list cell (leaf or index root) loaded for an in-place update
+struct SubkeyList {
+    uint32_t cell = kNoCell;
+    uint16_t signature = 0;
+    size_t count = 0;
+    std::vector<uint8_t> payload;  // header and `count` entries
+
+    bool IsLeaf() const {
+        return signature == kHashLeafSignature || signature == kFastLeafSignature ||
+               signature == kIndexLeafSignature;
+    }
+    size_t EntrySize() const {
+        return (signature == kHashLeafSignature || signature == kFastLeafSignature) ? 8 : 4;
+    }
+    uint8_t* Entry(size_t i) { return payload.data() + kListEntries + i * EntrySize(); }
+    uint32_t Cell(size_t i) const { return LoadU32(payload.data() + kListEntries + i * EntrySize()); }
+};
+
+bool ReadSubkeyList(const HiveImage& image, uint32_t cell, SubkeyList& list) {
+    if (cell == kNoCell || !image.ReadCell(cell, list.payload) || list.payload.size() < kListEntries) {
+        return false;
+    }
+    list.cell = cell;
+    list.signature = LoadU16(list.payload.data());
+    if (!list.IsLeaf() && list.signature != kIndexRootSignature) {
+        return false;
+    }
+    list.count = std::min<size_t>(LoadU16(list.payload.data() + kListCount),
+                                  (list.payload.size() - kListEntries) / list.EntrySize());
+    list.payload.resize(kListEntries + list.count * list.EntrySize());
+    return true;
+}
+
+// Insert an entry before entry `index`. Leaf entries carry the hash or hint
+// of `name`; index root entries are just the leaf cell.
+void InsertListEntry(SubkeyList& list, size_t index, uint32_t cell, const std::u16string& name, bool hashed) {
+    uint8_t entry[8];
+    StoreU32(entry, cell);
+    if (list.EntrySize() == 8) {
+        StoreU32(entry + 4, hashed ? NameHash(name) : NameHint(name));
+    }
+    size_t offset = kListEntries + index * list.EntrySize();
+    list.payload.insert(list.payload.begin() + offset, entry, entry + list.EntrySize());
+    ++list.count;
+}
+
+void EraseListEntry(SubkeyList& list, size_t index) {
+    auto entry = list.payload.begin() + kListEntries + index * list.EntrySize();
+    list.payload.erase(entry, entry + list.EntrySize());
+    --list.count;
+}
+
+// Write a list back, in place from entry `firstChanged` on if its cell is
+// still large enough, otherwise to a new cell (freeing the old one).
+// Returns the list's cell, or kNoCell if no cell could be allocated.
+uint32_t StoreSubkeyList(HiveImage& image, SubkeyList& list, size_t firstChanged) {
+    StoreU16(list.payload.data(), list.signature);
+    StoreU16(list.payload.data() + kListCount, static_cast<uint16_t>(list.count));
+
+    if (list.cell != kNoCell && image.CellCapacity(list.cell) >= list.payload.size()) {
+        size_t offset = kListEntries + firstChanged * list.EntrySize();
+        image.Write(Payload(list.cell), list.payload.data(), kListEntries);
+        if (offset < list.payload.size()) {
+            image.Write(Payload(list.cell) + static_cast<uint32_t>(offset), list.payload.data() + offset,
+                        list.payload.size() - offset);
+        }
+        return list.cell;
+    }
+
+    // Growing lists get headroom, so most inserts stay in place
+    size_t capacity = list.payload.size() + list.payload.size() / 2;
+    if (list.IsLeaf()) {
+        capacity = std::min(capacity, kListEntries + (kMaxLeafEntries + 1) * list.EntrySize());
+    }
+    uint32_t cell = image.AllocateCell(static_cast<uint32_t>(capacity));
+    if (cell == kNoCell) {
+        return kNoCell;
+    }
+    image.Write(Payload(cell), list.payload.data(), list.payload.size());
+    if (list.cell != kNoCell) {
+        image.FreeCell(list.cell);
+    }
+    list.cell = cell;
+    return cell;
+}
+
+// Position in a sorted leaf at which `name` belongs, reading only the key
+// nodes the binary search visits
+size_t LeafPosition(const HiveImage& image, const SubkeyList& leaf, const std::u16string& name) {
+    size_t low = 0;
+    size_t high = leaf.count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        KeyNode node;
+        if (ReadKeyNode(image, leaf.Cell(mid), node) && CompareNames(name, node.name) < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+// Index of the leaf of an index root that `name` sorts into: the last leaf
+// whose first name is not greater than it
+size_t RootPosition(const HiveImage& image, const SubkeyList& root, const std::u16string& name) {
+    size_t low = 0;
+    size_t high = root.count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        uint32_t leaf = root.Cell(mid);
+        KeyNode first;
+        if (image.ReadU16(Payload(leaf) + kListCount) > 0 &&
+            ReadKeyNode(image, image.ReadU32(Payload(leaf) + kListEntries), first) &&
+            CompareNames(name, first.name) < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low == 0 ? 0 : low - 1;
+}
+
+// Read a key's children with their names, in list order
+std::vector<std::pair<std::u16string, uint32_t>> ReadChildren(const HiveImage& image, const KeyNode& node) {
+    std::vector<std::pair<std::u16string, uint32_t>> children;
+    children.reserve(node.subkeyCount);
+    VisitSubkeys(image, node.subkeyList, [&](uint32_t cell, const uint32_t*) {
+        KeyNode child;
+        if (ReadKeyNode(image, cell, child)) {
+            children.emplace_back(std::move(child.name), cell);
+        }
+        return true;
+    });
+    return children;
+}
+
+// Read `size` bytes of a non-resident value's data starting at `offset`,
+// touching only the cells (or big data segments) that hold them
+bool ReadDataRange(const HiveImage& image, const ValueNode& node, size_t offset, size_t size, uint8_t* out) {
+    if ((node.dataSize & kValueDataResident) || offset + size > node.dataSize) {
+        return false;
+    }
+
+    uint32_t capacity = image.CellCapacity(node.dataOffset);
+    bool bigData = node.dataSize > kBigDataSegmentSize && image.MinorVersion() >= 4 &&
+                   capacity >= kBigDataSegmentList + 4 &&
+                   image.ReadU16(Payload(node.dataOffset)) == kBigDataSignature;
+    if (!bigData) {
+        return offset + size <= capacity && image.Read(Payload(node.dataOffset) + static_cast<uint32_t>(offset), out, size);
+    }
+
+    uint16_t segments = image.ReadU16(Payload(node.dataOffset) + kBigDataSegmentCount);
+    uint32_t list = image.ReadU32(Payload(node.dataOffset) + kBigDataSegmentList);
+    if (image.CellCapacity(list) < segments * 4u) {
+        return false;
+    }
+    while (size > 0) {
+        size_t index = offset / kBigDataSegmentSize;
+        size_t inSegment = offset % kBigDataSegmentSize;
+        if (index >= segments) {
+            return false;
+        }
+        uint32_t segment = image.ReadU32(Payload(list) + static_cast<uint32_t>(index * 4));
+        size_t take = std::min(size, kBigDataSegmentSize - inSegment);
+        if (inSegment + take > image.CellCapacity(segment) ||
+            !image.Read(Payload(segment) + static_cast<uint32_t>(inSegment), out, take)) {
+            return false;
+        }
+        out += take;
+        offset += take;
+        size -= take;
+    }
+    return true;
+}
+
+// Handle to a large value's data. Reads go straight to the hive's cells;
+// once the hive is modified the cells may have moved, so reads fail.
+class HiveLargeValue : public CachedLargeValue {
+public:
+    // Chunks are shared by handles to the same data cell until the image
+    // is next written
+    HiveLargeValue(const std::shared_ptr<const HiveImage>& image, const ValueNode& node,
+                   std::shared_ptr<ChunkCache> cache)
+        : CachedLargeValue(node.dataSize, {image->Id(), image->Generation(), node.dataOffset, {}}, std::move(cache)),
+          image_(image), generation_(image->Generation()) {
+        node_.dataSize = node.dataSize;
+        node_.dataOffset = node.dataOffset;
+    }
+
+protected:
+    bool LoadChunk(size_t index, std::vector<uint8_t>& out) const override {
+        auto image = image_.lock();
+        if (!image || image->Generation() != generation_) {
+            return false;
+        }
+        size_t offset = index * kValueChunkSize;
+        out.resize(std::min(kValueChunkSize, Size() - offset));
+        return ReadDataRange(*image, node_, offset, out.size(), out.data());
+    }
+
+private:
+    std::weak_ptr<const HiveImage> image_;
+    ValueNode node_;
+    uint64_t generation_;
+};
+
+} // namespace
+
+HiveRegistryManager::HiveRegistryManager(std::unique_ptr<HiveImage> image)
+    : image_(std::move(image)) {
+}
+
+HiveRegistryManager::~HiveRegistryManager() = default;
+
+std::unique_ptr<HiveRegistryManager> HiveRegistryManager::Open(const std::string& path) {
+    std::vector<std::string> logPaths;
+    for (const char* suffix : {".LOG1", ".LOG2", ".LOG", ".log1", ".log2", ".log"}) {
+        logPaths.push_back(path + suffix);
+    }
+    return Open(path, logPaths);
+}
+
+std::unique_ptr<HiveRegistryManager> HiveRegistryManager::Open(const std::string& path,
+                                                               const std::vector<std::string>& logPaths) {
+    auto image = HiveImage::Open(path);
+    if (!image) {
+        return nullptr;
+    }
+    bool readOnly = image->IsDirty() && !image->Recover(logPaths);
+
+    KeyNode root;
+    if (!ReadKeyNode(*image, image->RootCell(), root)) {
+        return nullptr;
+    }
+    std::unique_ptr<HiveRegistryManager> manager(new HiveRegistryManager(std::move(image)));
+    manager->read_only_ = readOnly;
+    return manager;
+}
+
+std::optional<Key> HiveRegistryManager::OpenKey(const std::string& path) {
+    return OpenKeyAt(FindKey(path), path);
+}
+
+std::vector<Value> HiveRegistryManager::GetValues(const std::string& path) {
+    return GetValuesAt(FindKey(path));
+}
+
+std::vector<std::string> HiveRegistryManager::GetSubkeys(const std::string& path) {
+    return GetSubkeysAt(FindKey(path));
+}
+
+bool HiveRegistryManager::CreateKey(const std::string& path) {
+    if (read_only_) {
+        return false;
+    }
+
+    uint32_t key = image_->RootCell();
+    for (const auto& component : SplitPath(path)) {
+        uint32_t child = FindChild(key, component);
+        if (child == kNoCell) {
+            child = CreateChild(key, component);
+            if (child == kNoCell) {
+                return false;
+            }
+        }
+        key = child;
+    }
+    return true;
+}
+
+bool HiveRegistryManager::DeleteKey(const std::string& path) {
+    return DeleteKeyAt(FindKey(path));
+}
+
+bool HiveRegistryManager::SetValue(const std::string& path, const Value& value) {
+    return SetValueAt(FindKey(path), value);
+}
+
+bool HiveRegistryManager::DeleteValue(const std::string& path, const std::string& valueName) {
+    return DeleteValueAt(FindKey(path), valueName);
+}
+
+std::optional<Key> HiveRegistryManager::OpenKey(KeyId key) {
+    return OpenKeyAt(FindKey(key), paths_.Path(key));
+}
+
+std::vector<Value> HiveRegistryManager::GetValues(KeyId key) {
+    return GetValuesAt(FindKey(key));
+}
+
+std::vector<std::string> HiveRegistryManager::GetSubkeys(KeyId key) {
+    return GetSubkeysAt(FindKey(key));
+}
+
+bool HiveRegistryManager::DeleteKey(KeyId key) {
+    return DeleteKeyAt(FindKey(key));
+}
+
+bool HiveRegistryManager::SetValue(KeyId key, const Value& value) {
+    return SetValueAt(FindKey(key), value);
+}
+
+bool HiveRegistryManager::DeleteValue(KeyId key, const std::string& valueName) {
+    return DeleteValueAt(FindKey(key), valueName);
+}
+
+size_t HiveRegistryManager::MemoryUsage() const {
+    return image_->OverlayBytes() + image_->ResidentBytes() + OwnChunkCacheBytes();
+}
+
+bool HiveRegistryManager::ReplayedLogs() const {
+    return image_->WasRecovered();
+}
+
+bool HiveRegistryManager::HasUnsavedChanges() const {
+    return image_->HasUnsavedChanges();
+}
+
+bool HiveRegistryManager::Save() {
+    return image_->Save();
+}
+
+bool HiveRegistryManager::SaveAs(const std::string& path) const {
+    return !read_only_ && image_->SaveAs(path);
+}
+
+// Helper methods
+std::optional<Key> HiveRegistryManager::OpenKeyAt(uint32_t cell, const std::string& path) const {
+    KeyNode node;
+    if (cell == kNoCell || !ReadKeyNode(*image_, cell, node)) {
+        return std::nullopt;
+    }
+
+    Key key;
+    key.name = Utf16ToUtf8(node.name.data(), node.name.size());
+    key.path = path;
+    key.values = GetValuesAt(cell);
+    key.subkeys = GetSubkeysAt(cell);
+    return key;
+}
+
+std::vector<Value> HiveRegistryManager::GetValuesAt(uint32_t key) const {
+    if (key == kNoCell) {
+        return {};
+    }
+
+    std::vector<uint32_t> cells = GetValueCells(key);
+    std::vector<Value> values;
+    values.reserve(cells.size());
+
+    // With limits set, the data loaded here counts against the chunk cache
+    // budget; once it would be exceeded, the remaining values are returned
+    // as handles too
+    size_t threshold = value_limits_.largeValueThreshold;
+    size_t eagerBytes = 0;
+
+    std::vector<uint8_t> data;
+    for (uint32_t cell : cells) {
+        ValueNode node;
+        if (!ReadValueNode(*image_, cell, node)) {
+            continue;
+        }
+        Value value;
+        value.name = Utf16ToUtf8(node.name.data(), node.name.size());
+        value.type = ValueTypeFromRaw(node.type);
+        value.rawType = node.type;
+        if (threshold != 0 && !(node.dataSize & kValueDataResident)) {
+            if (node.dataSize > threshold || node.dataSize > value_limits_.chunkCacheBytes - eagerBytes) {
+                value.large = std::make_shared<HiveLargeValue>(image_, node, chunk_cache_);
+                values.push_back(std::move(value));
+                continue;
+            }
+            eagerBytes += node.dataSize;
+        }
+        ReadValueBytes(cell, data);
+        DecodeValueData(value.type, data.data(), data.size(), value.data);
+        values.push_back(std::move(value));
+    }
+    return values;
+}
+
+std::vector<std::string> HiveRegistryManager::GetSubkeysAt(uint32_t key) const {
+    KeyNode node;
+    if (key == kNoCell || !ReadKeyNode(*image_, key, node)) {
+        return {};
+    }
+
+    std::vector<std::string> subkeys;
+    subkeys.reserve(node.subkeyCount);
+    for (const auto& child : ReadChildren(*image_, node)) {
+        subkeys.push_back(Utf16ToUtf8(child.first.data(), child.first.size()));
+    }
+    return subkeys;
+}
+
+bool HiveRegistryManager::DeleteKeyAt(uint32_t key) {
+    KeyNode node;
+    if (read_only_ || key == kNoCell || key == image_->RootCell() || !ReadKeyNode(*image_, key, node)) {
+        return false;
+    }
+
+    // Like RegDeleteKey, only keys without subkeys can be deleted
+    if (node.subkeyCount > 0) {
+        return false;
+    }
+
+    if (!RemoveSubkey(node.parent, key)) {
+        return false;
+    }
+
+    for (uint32_t cell : GetValueCells(key)) {
+        FreeValueBytes(cell);
+        image_->FreeCell(cell);
+    }
+    if (node.valueList != kNoCell) {
+        image_->FreeCell(node.valueList);
+    }
+    if (node.className != kNoCell) {
+        image_->FreeCell(node.className);
+    }
+    FreeSubkeyList(*image_, node.subkeyList);
+    ReleaseSecurity(node.security);
+    image_->FreeCell(key);
+
+    // The freed cell may be reused by a later key
+    key_cells_.clear();
+    return true;
+}
+
+bool HiveRegistryManager::SetValueAt(uint32_t key, const Value& value) {
+    KeyNode node;
+    if (read_only_ || key == kNoCell || !ReadKeyNode(*image_, key, node)) {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    if (!EncodeValueData(value, data)) {
+        return false;
+    }
+
+    std::u16string name;
+    Utf8ToUtf16(value.name, name);
+
+    std::vector<uint32_t> cells = GetValueCells(key);
+    uint32_t valueCell = kNoCell;
+    for (uint32_t cell : cells) {
+        ValueNode existing;
+        if (ReadValueNode(*image_, cell, existing) && CompareNames(existing.name, name) == 0) {
+            valueCell = cell;
+            break;
+        }
+    }
+
+    uint32_t sizeField = 0;
+    uint32_t dataOffset = StoreValueBytes(data, sizeField);
+    if (dataOffset == kNoCell && data.size() > 4) {
+        return false;
+    }
+
+    if (valueCell != kNoCell) {
+        FreeValueBytes(valueCell);
+    } else {
+        std::vector<uint8_t> encodedName;
+        bool compressed = EncodeName(name, encodedName);
+
+        valueCell = image_->AllocateCell(static_cast<uint32_t>(kValueName + encodedName.size()));
+        if (valueCell == kNoCell) {
+            FreeDataCells(sizeField, dataOffset);
+            return false;
+        }
+        std::vector<uint8_t> payload(kValueName + encodedName.size(), 0);
+        StoreU16(payload.data(), kValueSignature);
+        StoreU16(payload.data() + kValueNameLength, static_cast<uint16_t>(encodedName.size()));
+        StoreU16(payload.data() + kValueFlags, compressed ? kValueFlagCompressedName : 0);
+        std::copy(encodedName.begin(), encodedName.end(), payload.begin() + kValueName);
+        image_->Write(Payload(valueCell), payload.data(), payload.size());
+
+        // Append to the value list, reallocating it only when it is full
+        uint32_t list = node.valueList;
+        uint32_t count = static_cast<uint32_t>(cells.size());
+        if (list == kNoCell || image_->CellCapacity(list) / 4 < count + 1) {
+            uint32_t grown = image_->AllocateCell((count + 1) * 4);
+            if (grown == kNoCell) {
+                image_->FreeCell(valueCell);
+                FreeDataCells(sizeField, dataOffset);
+                return false;
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                image_->WriteU32(Payload(grown) + i * 4, cells[i]);
+            }
+            if (list != kNoCell) {
+                image_->FreeCell(list);
+            }
+            list = grown;
+            image_->WriteU32(Payload(key) + kKeyValueList, list);
+        }
+        image_->WriteU32(Payload(list) + count * 4, valueCell);
+        image_->WriteU32(Payload(key) + kKeyValueCount, count + 1);
+
+        uint32_t nameBytes = static_cast<uint32_t>(name.size() * 2);
+        if (image_->ReadU32(Payload(key) + kKeyMaxValueName) < nameBytes) {
+            image_->WriteU32(Payload(key) + kKeyMaxValueName, nameBytes);
+        }
+    }
+
+    image_->WriteU32(Payload(valueCell) + kValueDataSize, sizeField);
+    image_->WriteU32(Payload(valueCell) + kValueDataOffset, dataOffset);
+    image_->WriteU32(Payload(valueCell) + kValueType, RawValueType(value));
+
+    if (image_->ReadU32(Payload(key) + kKeyMaxValueData) < data.size()) {
+        image_->WriteU32(Payload(key) + kKeyMaxValueData, static_cast<uint32_t>(data.size()));
+    }
+    TouchKey(key);
+    return true;
+}
+
+bool HiveRegistryManager::DeleteValueAt(uint32_t key, const std::string& valueName) {
+    KeyNode node;
+    if (read_only_ || key == kNoCell || !ReadKeyNode(*image_, key, node)) {
+        return false;
+    }
+
+    std::u16string name;
+    Utf8ToUtf16(valueName, name);
+
+    std::vector<uint32_t> cells = GetValueCells(key);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        ValueNode existing;
+        if (!ReadValueNode(*image_, cells[i], existing) || CompareNames(existing.name, name) != 0) {
+            continue;
+        }
+
+        FreeValueBytes(cells[i]);
+        image_->FreeCell(cells[i]);
+        cells.erase(cells.begin() + static_cast<std::ptrdiff_t>(i));
+
+        if (cells.empty()) {
+            image_->FreeCell(node.valueList);
+            image_->WriteU32(Payload(key) + kKeyValueList, kNoCell);
+        } else {
+            for (size_t j = i; j < cells.size(); ++j) {
+                image_->WriteU32(Payload(node.valueList) + static_cast<uint32_t>(j * 4), cells[j]);
+            }
+        }
+        image_->WriteU32(Payload(key) + kKeyValueCount, static_cast<uint32_t>(cells.size()));
+        TouchKey(key);
+        return true;
+    }
+    return false;
+}
+
+uint32_t HiveRegistryManager::FindKey(const std::string& path) const {
+    uint32_t key = image_->RootCell();
+    for (const auto& component : SplitPath(path)) {
+        key = FindChild(key, component);
+        if (key == kNoCell) {
+            break;
+        }
+    }
+    return key;
+}
+
+uint32_t HiveRegistryManager::FindKey(KeyId id) const {
+    if (id == kRootKeyId) {
+        return image_->RootCell();
+    }
+    if (!paths_.IsValid(id)) {
+        return kNoCell;
+    }
+    if (id < key_cells_.size() && key_cells_[id] != kNoCell) {
+        return key_cells_[id];
+    }
+
+    uint32_t parent = FindKey(paths_.Parent(id));
+    if (parent == kNoCell) {
+        return kNoCell;
+    }
+    std::u16string name;
+    Utf8ToUtf16(paths_.Name(id), name);
+    uint32_t key = FindChild(parent, name);
+
+    // Only hits are cached; a missing key may be created later
+    if (key != kNoCell) {
+        if (id >= key_cells_.size()) {
+            key_cells_.resize(id + 1, kNoCell);
+        }
+        key_cells_[id] = key;
+    }
+    return key;
+}
+
+uint32_t HiveRegistryManager::FindChild(uint32_t key, const std::u16string& name) const {
+    KeyNode node;
+    if (!ReadKeyNode(*image_, key, node)) {
+        return kNoCell;
+    }
+
+    uint32_t hash = NameHash(name);
+    uint32_t found = kNoCell;
+    VisitSubkeys(*image_, node.subkeyList, [&](uint32_t cell, const uint32_t* storedHash) {
+        if (storedHash != nullptr && *storedHash != hash) {
+            return true;
+        }
+        KeyNode child;
+        if (ReadKeyNode(*image_, cell, child) && CompareNames(child.name, name) == 0) {
+            found = cell;
+            return false;
+        }
+        return true;
+    });
+    return found;
+}
+
+uint32_t HiveRegistryManager::CreateChild(uint32_t parent, const std::u16string& name) {
+    KeyNode parentNode;
+    if (!ReadKeyNode(*image_, parent, parentNode) || name.size() > 255) {
+        return kNoCell;
+    }
+
+    std::vector<uint8_t> encodedName;
+    bool compressed = EncodeName(name, encodedName);
+
+    std::vector<uint8_t> payload(kKeyName + encodedName.size(), 0);
+    uint8_t* p = payload.data();
+    StoreU16(p, kKeyNodeSignature);
+    StoreU16(p + kKeyFlags, compressed ? kKeyFlagCompressedName : 0);
+    StoreU32(p + kKeyParent, parent);
+    StoreU32(p + kKeySubkeyList, kNoCell);
+    StoreU32(p + kKeySubkeyList + 4, kNoCell);  // volatile subkey list
+    StoreU32(p + kKeyValueList, kNoCell);
+    StoreU32(p + kKeySecurity, parentNode.security);
+    StoreU32(p + kKeyClassName, kNoCell);
+    StoreU16(p + kKeyNameLength, static_cast<uint16_t>(encodedName.size()));
+    std::copy(encodedName.begin(), encodedName.end(), payload.begin() + kKeyName);
+
+    uint32_t cell = image_->AllocateCell(static_cast<uint32_t>(payload.size()));
+    if (cell == kNoCell) {
+        return kNoCell;
+    }
+    image_->Write(Payload(cell), payload.data(), payload.size());
+    TouchKey(cell);
+
+    if (!InsertSubkey(parent, cell)) {
+        image_->FreeCell(cell);
+        return kNoCell;
+    }
+
+    // New keys share the parent's security descriptor
+    if (parentNode.security != kNoCell) {
+        uint32_t refCount = Payload(parentNode.security) + kSecurityRefCount;
+        image_->WriteU32(refCount, image_->ReadU32(refCount) + 1);
+    }
+    return cell;
+}
+
+bool HiveRegistryManager::InsertSubkey(uint32_t parent, uint32_t child) {
+    KeyNode parentNode;
+    KeyNode childNode;
+    if (!ReadKeyNode(*image_, parent, parentNode) || !ReadKeyNode(*image_, child, childNode)) {
+        return false;
+    }
+
+    // Lists are kept sorted by upcased name. Only the leaf the child sorts
+    // into is rewritten, and the index root only when a leaf moves or splits.
+    SubkeyList root;  // signature 0 while the parent has no index root
+    SubkeyList leaf;
+    size_t leafIndex = 0;
+    if (parentNode.subkeyList != kNoCell) {
+        if (!ReadSubkeyList(*image_, parentNode.subkeyList, root)) {
+            return false;
+        }
+        if (root.IsLeaf()) {
+            leaf = std::move(root);
+            root = SubkeyList();
+        } else {
+            if (root.count == 0) {
+                return false;
+            }
+            leafIndex = RootPosition(*image_, root, childNode.name);
+            if (!ReadSubkeyList(*image_, root.Cell(leafIndex), leaf) || !leaf.IsLeaf()) {
+                return false;
+            }
+        }
+    }
+
+    uint32_t list = kNoCell;
+    if (leaf.signature == 0) {
+        list = WriteSubkeyList(*image_, {{childNode.name, child}});
+    } else {
+        bool hashed = leaf.signature == kHashLeafSignature;
+        size_t position = LeafPosition(*image_, leaf, childNode.name);
+        InsertListEntry(leaf, position, child, childNode.name, hashed);
+
+        // A full leaf is split in two, under a new index root if needed
+        SubkeyList upper;
+        if (leaf.count > kMaxLeafEntries) {
+            size_t half = leaf.count / 2;
+            upper.signature = leaf.signature;
+            upper.count = leaf.count - half;
+            upper.payload.assign(leaf.payload.begin(), leaf.payload.begin() + kListEntries);
+            upper.payload.insert(upper.payload.end(), leaf.Entry(half), leaf.payload.data() + leaf.payload.size());
+            leaf.payload.resize(kListEntries + half * leaf.EntrySize());
+            leaf.count = half;
+            position = std::min(position, half);
+            if (StoreSubkeyList(*image_, upper, 0) == kNoCell) {
+                return false;
+            }
+        }
+
+        uint32_t previousLeaf = leaf.cell;
+        if (StoreSubkeyList(*image_, leaf, position) == kNoCell) {
+            if (upper.cell != kNoCell) {
+                image_->FreeCell(upper.cell);
+            }
+            return false;
+        }
+
+        if (root.signature == 0 && upper.cell == kNoCell) {
+            list = leaf.cell;
+        } else {
+            if (root.signature == 0) {
+                root.signature = kIndexRootSignature;
+                root.payload.assign(kListEntries, 0);
+                InsertListEntry(root, 0, leaf.cell, {}, false);
+            } else if (leaf.cell != previousLeaf) {
+                StoreU32(root.Entry(leafIndex), leaf.cell);
+            }
+            if (upper.cell != kNoCell) {
+                InsertListEntry(root, leafIndex + 1, upper.cell, {}, false);
+            }
+            list = StoreSubkeyList(*image_, root, leafIndex);
+        }
+    }
+    if (list == kNoCell) {
+        return false;
+    }
+
+    image_->WriteU32(Payload(parent) + kKeySubkeyList, list);
+    image_->WriteU32(Payload(parent) + kKeySubkeyCount, parentNode.subkeyCount + 1);
+
+    // The low 16 bits hold the longest subkey name in bytes; the rest are flags
+    uint32_t maxName = image_->ReadU32(Payload(parent) + kKeyMaxSubkeyName);
+    uint32_t nameBytes = static_cast<uint32_t>(childNode.name.size() * 2);
+    if ((maxName & 0xFFFF) < nameBytes) {
+        image_->WriteU32(Payload(parent) + kKeyMaxSubkeyName, (maxName & 0xFFFF0000) | nameBytes);
+    }
+    TouchKey(parent);
+    return true;
+}
+
+bool HiveRegistryManager::RemoveSubkey(uint32_t parent, uint32_t child) {
+    KeyNode parentNode;
+    KeyNode childNode;
+    SubkeyList root;
+    if (!ReadKeyNode(*image_, parent, parentNode) || !ReadKeyNode(*image_, child, childNode) ||
+        !ReadSubkeyList(*image_, parentNode.subkeyList, root)) {
+        return false;
+    }
+
+    // Find the leaf holding the child, trying the one it sorts into first
+    SubkeyList leaf;
+    size_t leafIndex = 0;
+    size_t position = 0;
+    auto findIn = [&](SubkeyList& candidate) {
+        for (position = 0; position < candidate.count; ++position) {
+            if (candidate.Cell(position) == child) {
+                return true;
+            }
+        }
+        return false;
+    };
+    bool found = false;
+    if (root.IsLeaf()) {
+        leaf = std::move(root);
+        root = SubkeyList();
+        found = findIn(leaf);
+    } else if (root.count > 0) {
+        leafIndex = RootPosition(*image_, root, childNode.name);
+        found = ReadSubkeyList(*image_, root.Cell(leafIndex), leaf) && leaf.IsLeaf() && findIn(leaf);
+        for (size_t i = 0; !found && i < root.count; ++i) {
+            leafIndex = i;
+            found = ReadSubkeyList(*image_, root.Cell(i), leaf) && leaf.IsLeaf() && findIn(leaf);
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    // Shrinking lists are updated in place; emptied cells are freed
+    uint32_t list = kNoCell;
+    EraseListEntry(leaf, position);
+    if (leaf.count > 0) {
+        StoreSubkeyList(*image_, leaf, position);
+        list = root.signature == 0 ? leaf.cell : root.cell;
+    } else {
+        image_->FreeCell(leaf.cell);
+        if (root.signature != 0) {
+            EraseListEntry(root, leafIndex);
+            if (root.count > 0) {
+                list = StoreSubkeyList(*image_, root, leafIndex);
+            } else {
+                image_->FreeCell(root.cell);
+            }
+        }
+    }
+
+    image_->WriteU32(Payload(parent) + kKeySubkeyList, list);
+    image_->WriteU32(Payload(parent) + kKeySubkeyCount, parentNode.subkeyCount > 0 ? parentNode.subkeyCount - 1 : 0);
+    TouchKey(parent);
+    return true;
+}
+
+std::vector<uint32_t> HiveRegistryManager::GetValueCells(uint32_t key) const {
+    KeyNode node;
+    std::vector<uint8_t> payload;
+    if (!ReadKeyNode(*image_, key, node) || node.valueCount == 0 ||
+        !image_->ReadCell(node.valueList, payload)) {
+        return {};
+    }
+
+    size_t count = std::min<size_t>(node.valueCount, payload.size() / 4);
+    std::vector<uint32_t> cells(count);
+    for (size_t i = 0; i < count; ++i) {
+        cells[i] = LoadU32(payload.data() + i * 4);
+    }
+    return cells;
+}
+
+bool HiveRegistryManager::ReadValueBytes(uint32_t valueCell, std::vector<uint8_t>& out) const {
+    out.clear();
+    ValueNode node;
+    if (!ReadValueNode(*image_, valueCell, node)) {
+        return false;
+    }
+
+    // Up to four bytes are stored in the offset field itself
+    if (node.dataSize & kValueDataResident) {
+        uint32_t size = std::min<uint32_t>(node.dataSize & ~kValueDataResident, 4);
+        for (uint32_t i = 0; i < size; ++i) {
+            out.push_back(static_cast<uint8_t>(node.dataOffset >> (8 * i)));
+        }
+        return true;
+    }
+    if (node.dataSize == 0) {
+        return true;
+    }
+
+    std::vector<uint8_t> payload;
+    if (!image_->ReadCell(node.dataOffset, payload)) {
+        return false;
+    }
+
+    // Large values in 1.4+ hives are split into segments behind a db cell
+    if (node.dataSize > kBigDataSegmentSize && image_->MinorVersion() >= 4 &&
+        payload.size() >= kBigDataSegmentList + 4 && LoadU16(payload.data()) == kBigDataSignature) {
+        uint16_t segments = LoadU16(payload.data() + kBigDataSegmentCount);
+        std::vector<uint8_t> list;
+        if (!image_->ReadCell(LoadU32(payload.data() + kBigDataSegmentList), list)) {
+            return false;
+        }
+        out.reserve(node.dataSize);
+        std::vector<uint8_t> segment;
+        for (size_t i = 0; i < segments && (i + 1) * 4 <= list.size() && out.size() < node.dataSize; ++i) {
+            if (!image_->ReadCell(LoadU32(list.data() + i * 4), segment)) {
+                return false;
+            }
+            size_t take = std::min<size_t>({segment.size(), kBigDataSegmentSize, node.dataSize - out.size()});
+            out.insert(out.end(), segment.begin(), segment.begin() + static_cast<std::ptrdiff_t>(take));
+        }
+        return true;
+    }
+
+    payload.resize(std::min<size_t>(payload.size(), node.dataSize));
+    out.swap(payload);
+    return true;
+}
+
+uint32_t HiveRegistryManager::StoreValueBytes(const std::vector<uint8_t>& data, uint32_t& sizeField) {
+    uint32_t size = static_cast<uint32_t>(data.size());
+    if (size <= 4) {
+        uint32_t inline_data = 0;
+        for (uint32_t i = 0; i < size; ++i) {
+            inline_data |= static_cast<uint32_t>(data[i]) << (8 * i);
+        }
+        sizeField = size | kValueDataResident;
+        return inline_data;
+    }
+
+    sizeField = size;
+    if (size <= kBigDataSegmentSize || image_->MinorVersion() < 4) {
+        uint32_t cell = image_->AllocateCell(size);
+        if (cell != kNoCell) {
+            image_->Write(Payload(cell), data.data(), size);
+        }
+        return cell;
+    }
+
+    std::vector<uint32_t> segments;
+    for (uint32_t offset = 0; offset < size; offset += kBigDataSegmentSize) {
+        uint32_t length = std::min(kBigDataSegmentSize, size - offset);
+        uint32_t segment = image_->AllocateCell(length);
+        if (segment == kNoCell) {
+            for (uint32_t written : segments) {
+                image_->FreeCell(written);
+            }
+            return kNoCell;
+        }
+        image_->Write(Payload(segment), data.data() + offset, length);
+        segments.push_back(segment);
+    }
+
+    uint32_t list = image_->AllocateCell(static_cast<uint32_t>(segments.size() * 4));
+    uint32_t header = image_->AllocateCell(kBigDataSegmentList + 4);
+    if (list == kNoCell || header == kNoCell) {
+        for (uint32_t written : segments) {
+            image_->FreeCell(written);
+        }
+        image_->FreeCell(list);
+        image_->FreeCell(header);
+        return kNoCell;
+    }
+    for (size_t i = 0; i < segments.size(); ++i) {
+        image_->WriteU32(Payload(list) + static_cast<uint32_t>(i * 4), segments[i]);
+    }
+    uint8_t db[kBigDataSegmentList + 4];
+    StoreU16(db, kBigDataSignature);
+    StoreU16(db + kBigDataSegmentCount, static_cast<uint16_t>(segments.size()));
+    StoreU32(db + kBigDataSegmentList, list);
+    image_->Write(Payload(header), db, sizeof(db));
+    return header;
+}
+
+void HiveRegistryManager::FreeValueBytes(uint32_t valueCell) {
+    ValueNode node;
+    if (ReadValueNode(*image_, valueCell, node)) {
+        FreeDataCells(node.dataSize, node.dataOffset);
+    }
+}
+
+void HiveRegistryManager::FreeDataCells(uint32_t sizeField, uint32_t dataOffset) {
+    if ((sizeField & kValueDataResident) || sizeField == 0 || dataOffset == kNoCell) {
+        return;
+    }
+
+    std::vector<uint8_t> payload;
+    if (sizeField > kBigDataSegmentSize && image_->MinorVersion() >= 4 &&
+        image_->ReadCell(dataOffset, payload) && payload.size() >= kBigDataSegmentList + 4 &&
+        LoadU16(payload.data()) == kBigDataSignature) {
+        uint16_t segments = LoadU16(payload.data() + kBigDataSegmentCount);
+        uint32_t listCell = LoadU32(payload.data() + kBigDataSegmentList);
+        std::vector<uint8_t> list;
+        if (image_->ReadCell(listCell, list)) {
+            for (size_t i = 0; i < segments && (i + 1) * 4 <= list.size(); ++i) {
+                image_->FreeCell(LoadU32(list.data() + i * 4));
+            }
+            image_->FreeCell(listCell);
+        }
+    }
+    image_->FreeCell(dataOffset);
+}
+
+void HiveRegistryManager::ReleaseSecurity(uint32_t security) {
+    std::vector<uint8_t> payload;
+    if (security == kNoCell || !image_->ReadCell(security, payload) || payload.size() < kSecurityRefCount + 4 ||
+        LoadU16(payload.data()) != kSecuritySignature) {
+        return;
+    }
+
+    uint32_t refCount = LoadU32(payload.data() + kSecurityRefCount);
+    if (refCount > 1) {
+        image_->WriteU32(Payload(security) + kSecurityRefCount, refCount - 1);
+        return;
+    }
+
+    // Last reference: unlink from the descriptor list and free it
+    uint32_t next = LoadU32(payload.data() + kSecurityFlink);
+    uint32_t previous = LoadU32(payload.data() + kSecurityBlink);
+    if (next != security && previous != security) {
+        image_->WriteU32(Payload(previous) + kSecurityFlink, next);
+        image_->WriteU32(Payload(next) + kSecurityBlink, previous);
+    }
+    image_->FreeCell(security);
+}
+
+void HiveRegistryManager::TouchKey(uint32_t key) {
+    uint64_t now = CurrentFileTime();
+    image_->WriteU32(Payload(key) + kKeyTimestamp, static_cast<uint32_t>(now));
+    image_->WriteU32(Payload(key) + kKeyTimestamp + 4, static_cast<uint32_t>(now >> 32));
+}
+
+} // namespace registry
@@ -1,11 +1,106 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include "fleet_compare.h"
+#include "hive_registry_manager.h"
+#include "mounted_registry_manager.h"
+#include "value_cache.h"
 #include "ui_manager.h"
 
+namespace {
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--mount NAME=HIVE]... [--budget MB] [--value-budget MB] [--compare PATH]..." << std::endl;
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
+    // Offline hives given with --mount are browsed under one virtual root
+    auto mounted = std::make_unique<registry::MountedRegistryManager>();
+    std::vector<registry::FleetSource> sources;
+    std::vector<std::string> comparePaths;
+    std::optional<registry::ValueMemoryLimits> valueLimits;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--mount") == 0 && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            if (eq == std::string::npos || eq == 0 || eq + 1 == spec.size()) {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            std::string hivePath = spec.substr(eq + 1);
+            registry::RegistryFactory open = [hivePath]() -> std::unique_ptr<registry::RegistryManager> {
+                return registry::HiveRegistryManager::Open(hivePath);
+            };
+            if (!mounted->Mount(spec.substr(0, eq), open)) {
+                std::cerr << "Error: cannot mount " << spec << std::endl;
+                return 1;
+            }
+            sources.push_back({spec.substr(0, eq), open});
+        } else if (std::strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            size_t megabytes = std::strtoull(argv[++i], nullptr, 10);
+            mounted->SetMemoryBudget(megabytes * 1024 * 1024);
+        } else if (std::strcmp(argv[i], "--value-budget") == 0 && i + 1 < argc) {
+            // Values larger than one chunk are loaded on demand, through a
+            // chunk cache of the given size
+            registry::ValueMemoryLimits limits;
+            limits.largeValueThreshold = registry::kValueChunkSize;
+            limits.chunkCacheBytes = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+            valueLimits = limits;
+        } else if (std::strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            comparePaths.push_back(argv[++i]);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Compare the mounted hives instead of browsing them
+    if (!comparePaths.empty()) {
+        if (sources.empty()) {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        // Each worker opens its own sources, so the limits go into the
+        // factories. One cache serves them all to keep the budget fleet-wide.
+        if (valueLimits) {
+            std::shared_ptr<registry::ChunkCache> cache;
+            if (valueLimits->chunkCacheBytes != 0) {
+                cache = std::make_shared<registry::ChunkCache>(valueLimits->chunkCacheBytes);
+            }
+            for (auto& source : sources) {
+                source.open = [open = source.open, limits = *valueLimits, cache]() {
+                    std::unique_ptr<registry::RegistryManager> manager = open();
+                    if (manager) {
+                        manager->ShareValueMemoryLimits(limits, cache);
+                    }
+                    return manager;
+                };
+            }
+        }
+        registry::FleetReport report = registry::CompareFleet(sources, comparePaths);
+        std::cout << registry::FormatFleetReport(report);
+        return 0;
+    }
+
     std::cout << "Starting regedit-tui..." << std::endl;
-    
+
     try {
-        ui::UIManager ui_manager;
+        std::unique_ptr<registry::RegistryManager> manager;
+        std::string startPath;
+        if (!sources.empty()) {
+            manager = std::move(mounted);
+        } else {
+            manager = registry::RegistryManager::Create();
+            startPath = "HKEY_LOCAL_MACHINE\\SOFTWARE";
+        }
+        if (valueLimits) {
+            manager->SetValueMemoryLimits(*valueLimits);
+        }
+
+        ui::UIManager ui_manager(std::move(manager), startPath);
         ui_manager.Run();
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -14,6 +109,6 @@ int main(int argc, char* argv[]) {
         std::cerr << "Unknown error occurred" << std::endl;
         return 1;
     }
-    
+
     return 0;
 }
@@ -0,0 +1,393 @@
+#include "mounted_registry_manager.h"
+#include "text_encoding.h"
+#include <algorithm>
+
+namespace registry {
+
+namespace {
+
+// Sources are re-checked against the budget every this many accesses, in
+// addition to whenever one is opened
+constexpr uint64_t kBudgetCheckInterval = 64;
+
+// Measuring a source can be costly (a hive asks the kernel which pages of
+// its mapping are resident), so budget checks reuse a source's figure for
+// this long, except for the source being accessed
+constexpr std::chrono::milliseconds kUsageRefreshPeriod(250);
+
+std::vector<std::string> SplitPath(const std::string& path) {
+    std::vector<std::string> components;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('\\', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            components.push_back(path.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return components;
+}
+
+// Append virtual child names that the mounted source does not already list
+void MergeNames(std::vector<std::string>& names, const std::vector<std::string>& extra) {
+    for (const auto& name : extra) {
+        std::string folded = FoldCase(name);
+        bool present = std::any_of(names.begin(), names.end(), [&](const std::string& existing) {
+            return FoldCase(existing) == folded;
+        });
+        if (!present) {
+            names.push_back(name);
+        }
+    }
+}
+
+} // namespace
+
+MountedRegistryManager::MountedRegistryManager(size_t memoryBudget)
+    : memory_budget_(memoryBudget) {
+}
+
+MountedRegistryManager::~MountedRegistryManager() = default;
+
+bool MountedRegistryManager::Mount(const std::string& prefix, RegistryFactory factory, const std::string& target) {
+    std::vector<std::string> components = SplitPath(prefix);
+    if (components.empty() || !factory) {
+        return false;
+    }
+
+    Node* node = &root_;
+    for (const auto& component : components) {
+        auto& child = node->children[FoldCase(component)];
+        if (!child) {
+            child = std::make_unique<Node>();
+            child->name = component;
+        }
+        node = child.get();
+    }
+    if (node->mount) {
+        return false;
+    }
+
+    node->mount = std::make_unique<MountPoint>();
+    node->mount->prefix = prefix;
+    node->mount->target = target;
+    node->mount->factory = std::move(factory);
+    return true;
+}
+
+bool MountedRegistryManager::Unmount(const std::string& prefix) {
+    std::vector<std::string> components = SplitPath(prefix);
+    std::vector<Node*> chain = {&root_};
+    for (const auto& component : components) {
+        auto it = chain.back()->children.find(FoldCase(component));
+        if (it == chain.back()->children.end()) {
+            return false;
+        }
+        chain.push_back(it->second.get());
+    }
+
+    Node* node = chain.back();
+    if (node == &root_ || !node->mount ||
+        (node->mount->manager && node->mount->manager->HasUnsavedChanges())) {
+        return false;
+    }
+    node->mount.reset();
+
+    // Prune trie nodes that no longer lead to a mount
+    for (size_t i = chain.size() - 1; i > 0; --i) {
+        if (chain[i]->mount || !chain[i]->children.empty()) {
+            break;
+        }
+        chain[i - 1]->children.erase(FoldCase(components[i - 1]));
+    }
+    return true;
+}
+
+std::vector<std::string> MountedRegistryManager::GetMounts() const {
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+
+    std::vector<std::string> prefixes;
+    for (const auto* mount : mounts) {
+        prefixes.push_back(mount->prefix);
+    }
+    return prefixes;
+}
+
+void MountedRegistryManager::SetMemoryBudget(size_t bytes) {
+    memory_budget_ = bytes;
+    EnforceBudget(nullptr);
+}
+
+std::optional<Key> MountedRegistryManager::OpenKey(const std::string& path) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+
+    std::optional<Key> key;
+    if (manager) {
+        key = manager->OpenKey(route.path);
+    }
+    if (!key && !route.exact) {
+        return std::nullopt;
+    }
+    if (!key) {
+        key = Key{};
+    }
+
+    std::vector<std::string> components = SplitPath(path);
+    key->name = components.empty() ? "" : components.back();
+    key->path = path;
+    if (route.exact) {
+        std::vector<std::string> children;
+        for (const auto& child : route.node->children) {
+            children.push_back(child.second->name);
+        }
+        MergeNames(key->subkeys, children);
+    }
+    return key;
+}
+
+std::vector<Value> MountedRegistryManager::GetValues(const std::string& path) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+    return manager ? manager->GetValues(route.path) : std::vector<Value>{};
+}
+
+std::vector<std::string> MountedRegistryManager::GetSubkeys(const std::string& path) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+
+    std::vector<std::string> subkeys;
+    if (manager) {
+        subkeys = manager->GetSubkeys(route.path);
+    }
+    if (route.exact) {
+        std::vector<std::string> children;
+        for (const auto& child : route.node->children) {
+            children.push_back(child.second->name);
+        }
+        MergeNames(subkeys, children);
+    }
+    return subkeys;
+}
+
+bool MountedRegistryManager::CreateKey(const std::string& path) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+    return manager && manager->CreateKey(route.path);
+}
+
+bool MountedRegistryManager::DeleteKey(const std::string& path) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+    return manager && manager->DeleteKey(route.path);
+}
+
+bool MountedRegistryManager::SetValue(const std::string& path, const Value& value) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+    return manager && manager->SetValue(route.path, value);
+}
+
+bool MountedRegistryManager::DeleteValue(const std::string& path, const std::string& valueName) {
+    Route route = Resolve(path);
+    RegistryManager* manager = route.mount ? Acquire(*route.mount) : nullptr;
+    return manager && manager->DeleteValue(route.path, valueName);
+}
+
+void MountedRegistryManager::SetValueMemoryLimits(const ValueMemoryLimits& limits) {
+    RegistryManager::SetValueMemoryLimits(limits);
+
+    // Sources share this manager's cache, so the budget covers all of
+    // them. Sources opened later pick it up in Acquire.
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+    for (auto* mount : mounts) {
+        if (mount->manager) {
+            mount->manager->ShareValueMemoryLimits(limits, chunk_cache_);
+        }
+    }
+}
+
+void MountedRegistryManager::SetParallelEnumeration(const ParallelEnumeration& options) {
+    RegistryManager::SetParallelEnumeration(options);
+
+    // Sources opened later pick the options up in Acquire
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+    for (auto* mount : mounts) {
+        if (mount->manager) {
+            mount->manager->SetParallelEnumeration(options);
+        }
+    }
+}
+
+size_t MountedRegistryManager::MemoryUsage() const {
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+
+    size_t total = OwnChunkCacheBytes();
+    for (const auto* mount : mounts) {
+        if (mount->manager) {
+            total += mount->manager->MemoryUsage();
+        }
+    }
+    return total;
+}
+
+bool MountedRegistryManager::HasUnsavedChanges() const {
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+    return std::any_of(mounts.begin(), mounts.end(), [](const MountPoint* mount) {
+        return mount->manager && mount->manager->HasUnsavedChanges();
+    });
+}
+
+bool MountedRegistryManager::Save() {
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+
+    bool saved = true;
+    for (auto* mount : mounts) {
+        if (mount->manager && mount->manager->HasUnsavedChanges() && !mount->manager->Save()) {
+            saved = false;
+        }
+    }
+    return saved;
+}
+
+bool MountedRegistryManager::Save(const std::string& prefix) {
+    MountPoint* mount = FindMount(prefix);
+    if (!mount) {
+        return false;
+    }
+    // A closed source has nothing to save
+    return !mount->manager || !mount->manager->HasUnsavedChanges() || mount->manager->Save();
+}
+
+std::vector<std::string> MountedRegistryManager::GetUnsavedMounts() const {
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+
+    std::vector<std::string> prefixes;
+    for (const auto* mount : mounts) {
+        if (mount->manager && mount->manager->HasUnsavedChanges()) {
+            prefixes.push_back(mount->prefix);
+        }
+    }
+    return prefixes;
+}
+
+// Helper methods
+MountedRegistryManager::Route MountedRegistryManager::Resolve(const std::string& path) const {
+    std::vector<std::string> components = SplitPath(path);
+
+    Route route;
+    route.node = &root_;
+    size_t mountDepth = 0;
+    size_t depth = 0;
+    for (; depth < components.size(); ++depth) {
+        auto it = route.node->children.find(FoldCase(components[depth]));
+        if (it == route.node->children.end()) {
+            break;
+        }
+        route.node = it->second.get();
+        if (route.node->mount) {
+            route.mount = route.node->mount.get();
+            mountDepth = depth + 1;
+        }
+    }
+    route.exact = depth == components.size();
+
+    if (route.mount) {
+        route.path = route.mount->target;
+        for (size_t i = mountDepth; i < components.size(); ++i) {
+            if (!route.path.empty()) {
+                route.path += '\\';
+            }
+            route.path += components[i];
+        }
+    }
+    return route;
+}
+
+MountedRegistryManager::MountPoint* MountedRegistryManager::FindMount(const std::string& prefix) const {
+    const Node* node = &root_;
+    for (const auto& component : SplitPath(prefix)) {
+        auto it = node->children.find(FoldCase(component));
+        if (it == node->children.end()) {
+            return nullptr;
+        }
+        node = it->second.get();
+    }
+    return node->mount.get();
+}
+
+RegistryManager* MountedRegistryManager::Acquire(MountPoint& mount) {
+    mount.lastUse = ++clock_;
+
+    if (!mount.manager) {
+        mount.manager = mount.factory();
+        if (!mount.manager) {
+            return nullptr;
+        }
+        mount.manager->ShareValueMemoryLimits(GetValueMemoryLimits(), chunk_cache_);
+        mount.manager->SetParallelEnumeration(GetParallelEnumeration());
+        EnforceBudget(&mount);
+    } else if (clock_ % kBudgetCheckInterval == 0) {
+        EnforceBudget(&mount);
+    }
+    return mount.manager.get();
+}
+
+void MountedRegistryManager::EnforceBudget(const MountPoint* keep) {
+    if (memory_budget_ == 0) {
+        return;
+    }
+
+    std::vector<MountPoint*> mounts;
+    CollectMounts(root_, mounts);
+
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::pair<MountPoint*, size_t>> open;
+    size_t total = 0;
+    for (auto* mount : mounts) {
+        if (mount->manager) {
+            if (mount == keep || now - mount->usageTime >= kUsageRefreshPeriod) {
+                mount->usage = mount->manager->MemoryUsage();
+                mount->usageTime = now;
+            }
+            open.emplace_back(mount, mount->usage);
+            total += mount->usage;
+        }
+    }
+
+    // Close least recently used sources first
+    std::sort(open.begin(), open.end(), [](const auto& a, const auto& b) {
+        return a.first->lastUse < b.first->lastUse;
+    });
+    for (auto& [mount, usage] : open) {
+        if (total <= memory_budget_) {
+            break;
+        }
+        if (mount == keep || mount->manager->HasUnsavedChanges()) {
+            continue;
+        }
+        mount->manager.reset();
+        total -= usage;
+    }
+}
+
+void MountedRegistryManager::CollectMounts(const Node& node, std::vector<MountPoint*>& out) const {
+    if (node.mount) {
+        out.push_back(node.mount.get());
+    }
+    for (const auto& child : node.children) {
+        CollectMounts(*child.second, out);
+    }
+}
+
+} // namespace registry
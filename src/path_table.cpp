@@ -0,0 +1,72 @@
+#include "path_table.h"
+#include "text_encoding.h"
+
+namespace registry {
+
+namespace {
+
+const std::string kEmpty;
+
+} // namespace
+
+PathTable::PathTable() {
+    entries_.push_back({kInvalidKeyId, "", ""});
+}
+
+KeyId PathTable::Child(KeyId parent, const std::string& name) {
+    if (!IsValid(parent)) {
+        return kInvalidKeyId;
+    }
+
+    auto [it, inserted] = children_.emplace(ChildKey(parent, name), static_cast<KeyId>(entries_.size()));
+    if (inserted) {
+        const std::string& parentPath = entries_[parent].path;
+        entries_.push_back({parent, name, parentPath.empty() ? name : parentPath + "\\" + name});
+    }
+    return it->second;
+}
+
+KeyId PathTable::FindChild(KeyId parent, const std::string& name) const {
+    auto it = children_.find(ChildKey(parent, name));
+    return it != children_.end() ? it->second : kInvalidKeyId;
+}
+
+KeyId PathTable::Intern(const std::string& path) {
+    KeyId id = kRootKeyId;
+    size_t start = 0;
+    while (start <= path.size() && id != kInvalidKeyId) {
+        size_t end = path.find('\\', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            id = Child(id, path.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return id;
+}
+
+KeyId PathTable::Parent(KeyId id) const {
+    return IsValid(id) ? entries_[id].parent : kInvalidKeyId;
+}
+
+const std::string& PathTable::Name(KeyId id) const {
+    return IsValid(id) ? entries_[id].name : kEmpty;
+}
+
+const std::string& PathTable::Path(KeyId id) const {
+    return IsValid(id) ? entries_[id].path : kEmpty;
+}
+
+// Helper methods
+std::string PathTable::ChildKey(KeyId parent, const std::string& name) {
+    std::string key(sizeof(parent), '\0');
+    for (size_t i = 0; i < sizeof(parent); ++i) {
+        key[i] = static_cast<char>(parent >> (8 * i));
+    }
+    AppendFoldedCase(name, key);
+    return key;
+}
+
+} // namespace registry
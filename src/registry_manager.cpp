@@ -1,4 +1,8 @@
 #include "registry_manager.h"
+#include "value_cache.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
 
 #ifdef PLATFORM_WINDOWS
 #include "windows_registry_manager.h"
@@ -6,6 +10,103 @@
 
 namespace registry {
 
+std::string RegistryManager::ValueTypeToString(ValueType type) {
+    switch (type) {
+        case ValueType::REG_NONE: return "REG_NONE";
+        case ValueType::REG_SZ: return "REG_SZ";
+        case ValueType::REG_EXPAND_SZ: return "REG_EXPAND_SZ";
+        case ValueType::REG_BINARY: return "REG_BINARY";
+        case ValueType::REG_DWORD: return "REG_DWORD";
+        case ValueType::REG_DWORD_BIG_ENDIAN: return "REG_DWORD_BIG_ENDIAN";
+        case ValueType::REG_LINK: return "REG_LINK";
+        case ValueType::REG_MULTI_SZ: return "REG_MULTI_SZ";
+        case ValueType::REG_RESOURCE_LIST: return "REG_RESOURCE_LIST";
+        case ValueType::REG_QWORD: return "REG_QWORD";
+        default: return "UNKNOWN";
+    }
+}
+
+std::string RegistryManager::ValueDataToString(const Value& value) {
+    char buffer[32];
+    if (value.large) {
+        // Large values are only read on demand, e.g. by a hex view
+        return "(" + std::to_string(value.large->Size()) + " bytes, not loaded)";
+    }
+    if (const auto* text = std::get_if<std::string>(&value.data)) {
+        return *text;
+    }
+    if (const auto* dword = std::get_if<uint32_t>(&value.data)) {
+        std::snprintf(buffer, sizeof(buffer), "0x%08x (%u)", *dword, *dword);
+        return buffer;
+    }
+    if (const auto* qword = std::get_if<uint64_t>(&value.data)) {
+        std::snprintf(buffer, sizeof(buffer), "0x%016llx", static_cast<unsigned long long>(*qword));
+        return buffer;
+    }
+    if (const auto* strings = std::get_if<std::vector<std::string>>(&value.data)) {
+        std::string result;
+        for (size_t i = 0; i < strings->size(); ++i) {
+            result += (i == 0 ? "" : "; ") + (*strings)[i];
+        }
+        return result;
+    }
+    if (const auto* bytes = std::get_if<std::vector<uint8_t>>(&value.data)) {
+        std::string result;
+        for (size_t i = 0; i < bytes->size(); ++i) {
+            std::snprintf(buffer, sizeof(buffer), i == 0 ? "%02x" : " %02x", (*bytes)[i]);
+            result += buffer;
+        }
+        return result;
+    }
+    return "(value not set)";
+}
+
+bool LargeValue::StreamTo(std::ostream& out) const {
+    std::vector<uint8_t> buffer(kValueChunkSize);
+    size_t size = Size();
+    for (size_t offset = 0; offset < size;) {
+        size_t read = ReadChunk(offset, buffer.data(), std::min(buffer.size(), size - offset));
+        if (read == 0) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(read));
+        offset += read;
+    }
+    return static_cast<bool>(out);
+}
+
+void RegistryManager::SetValueMemoryLimits(const ValueMemoryLimits& limits) {
+    value_limits_ = limits;
+    if (limits.chunkCacheBytes == 0) {
+        chunk_cache_.reset();
+    } else if (chunk_cache_ && !chunk_cache_shared_) {
+        chunk_cache_->SetBudget(limits.chunkCacheBytes);
+    } else {
+        chunk_cache_ = std::make_shared<ChunkCache>(limits.chunkCacheBytes);
+    }
+    chunk_cache_shared_ = false;
+}
+
+void RegistryManager::ShareValueMemoryLimits(const ValueMemoryLimits& limits, std::shared_ptr<ChunkCache> cache) {
+    value_limits_ = limits;
+    chunk_cache_ = std::move(cache);
+    chunk_cache_shared_ = chunk_cache_ != nullptr;
+}
+
+size_t RegistryManager::OwnChunkCacheBytes() const {
+    return chunk_cache_ && !chunk_cache_shared_ ? chunk_cache_->Bytes() : 0;
+}
+
+std::vector<KeyId> RegistryManager::GetSubkeyIds(KeyId key) {
+    std::vector<std::string> names = GetSubkeys(key);
+    std::vector<KeyId> ids;
+    ids.reserve(names.size());
+    for (const auto& name : names) {
+        ids.push_back(paths_.Child(key, name));
+    }
+    return ids;
+}
+
 // Factory method implementation
 std::unique_ptr<RegistryManager> RegistryManager::Create() {
 #ifdef PLATFORM_WINDOWS
@@ -14,6 +115,14 @@ std::unique_ptr<RegistryManager> RegistryManager::Create() {
     // Return stub implementation for non-Windows platforms
     class StubRegistryManager : public RegistryManager {
     public:
+        using RegistryManager::OpenKey;
+        using RegistryManager::GetValues;
+        using RegistryManager::GetSubkeys;
+        using RegistryManager::CreateKey;
+        using RegistryManager::DeleteKey;
+        using RegistryManager::SetValue;
+        using RegistryManager::DeleteValue;
+
         std::optional<Key> OpenKey(const std::string& path) override {
             Key key;
             key.name = path.substr(path.find_last_of('\\') + 1);
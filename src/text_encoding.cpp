@@ -0,0 +1,238 @@
+#include "text_encoding.h"
+#include <cstring>
+
+// REGEDIT_TUI_NO_SIMD and REGEDIT_TUI_NO_SWAR turn off the block fast paths,
+// so the benchmarks can measure each path on its own
+#if !defined(REGEDIT_TUI_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define REGEDIT_TUI_HAVE_SSE2 1
+#endif
+
+namespace registry {
+
+namespace {
+
+constexpr char16_t kReplacementChar = 0xFFFD;
+
+inline bool IsContinuation(uint8_t c) {
+    return (c & 0xC0) == 0x80;
+}
+
+// Widen a run of ASCII bytes. Returns the number of bytes consumed; stops
+// at the first block that contains a non-ASCII byte.
+size_t WidenAscii([[maybe_unused]] const uint8_t* src, [[maybe_unused]] size_t size,
+                  [[maybe_unused]] char16_t* dst) {
+    size_t i = 0;
+#ifdef REGEDIT_TUI_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(bytes) != 0) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#endif
+#ifndef REGEDIT_TUI_NO_SWAR
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, src + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+        for (size_t j = 0; j < 8; ++j) {
+            dst[i + j] = src[i + j];
+        }
+    }
+#endif
+    return i;
+}
+
+// Narrow a run of UTF-16 code units below U+0080. Returns the number of
+// units consumed; stops at the first block that contains a wider unit.
+size_t NarrowAscii([[maybe_unused]] const char16_t* src, [[maybe_unused]] size_t size,
+                   [[maybe_unused]] char* dst) {
+    size_t i = 0;
+#ifdef REGEDIT_TUI_HAVE_SSE2
+    const __m128i high_mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        __m128i high_bits = _mm_and_si128(_mm_or_si128(lo, hi), high_mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, zero)) != 0xFFFF) {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+#ifndef REGEDIT_TUI_NO_SWAR
+    for (; i + 4 <= size; i += 4) {
+        uint64_t word;
+        std::memcpy(&word, src + i, sizeof(word));
+        if (word & 0xFF80FF80FF80FF80ULL) {
+            break;
+        }
+        for (size_t j = 0; j < 4; ++j) {
+            dst[i + j] = static_cast<char>(src[i + j]);
+        }
+    }
+#endif
+    return i;
+}
+
+} // namespace
+
+void Utf8ToUtf16(const char* data, size_t size, std::u16string& out) {
+    // A UTF-16 encoding never has more code units than the UTF-8 input has bytes
+    out.resize(size);
+    if (size == 0) {
+        return;
+    }
+
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(data);
+    char16_t* dst = &out[0];
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < size) {
+        if (src[i] < 0x80) {
+            size_t run = WidenAscii(src + i, size - i, dst + o);
+            i += run;
+            o += run;
+            while (i < size && src[i] < 0x80) {
+                dst[o++] = src[i++];
+            }
+            continue;
+        }
+
+        uint8_t c = src[i];
+        size_t remaining = size - i;
+        uint32_t cp = 0;
+        size_t length = 0;
+
+        if (c >= 0xC2 && c <= 0xDF) {
+            if (remaining >= 2 && IsContinuation(src[i + 1])) {
+                cp = ((c & 0x1Fu) << 6) | (src[i + 1] & 0x3Fu);
+                length = 2;
+            }
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            if (remaining >= 3 && IsContinuation(src[i + 1]) && IsContinuation(src[i + 2]) &&
+                !(c == 0xE0 && src[i + 1] < 0xA0) &&   // overlong
+                !(c == 0xED && src[i + 1] > 0x9F)) {   // surrogate
+                cp = ((c & 0x0Fu) << 12) | ((src[i + 1] & 0x3Fu) << 6) | (src[i + 2] & 0x3Fu);
+                length = 3;
+            }
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            if (remaining >= 4 && IsContinuation(src[i + 1]) && IsContinuation(src[i + 2]) &&
+                IsContinuation(src[i + 3]) &&
+                !(c == 0xF0 && src[i + 1] < 0x90) &&   // overlong
+                !(c == 0xF4 && src[i + 1] > 0x8F)) {   // above U+10FFFF
+                cp = ((c & 0x07u) << 18) | ((src[i + 1] & 0x3Fu) << 12) |
+                     ((src[i + 2] & 0x3Fu) << 6) | (src[i + 3] & 0x3Fu);
+                length = 4;
+            }
+        }
+
+        if (length == 0) {
+            dst[o++] = kReplacementChar;
+            i += 1;
+        } else if (cp >= 0x10000) {
+            cp -= 0x10000;
+            dst[o++] = static_cast<char16_t>(0xD800 + (cp >> 10));
+            dst[o++] = static_cast<char16_t>(0xDC00 + (cp & 0x3FF));
+            i += length;
+        } else {
+            dst[o++] = static_cast<char16_t>(cp);
+            i += length;
+        }
+    }
+
+    out.resize(o);
+}
+
+void Utf8ToUtf16(const std::string& str, std::u16string& out) {
+    Utf8ToUtf16(str.data(), str.size(), out);
+}
+
+void Utf16ToUtf8(const char16_t* data, size_t size, std::string& out) {
+    // Every code unit expands to at most three bytes (a surrogate pair to four)
+    out.resize(size * 3);
+    if (size == 0) {
+        return;
+    }
+
+    char* dst = &out[0];
+    size_t i = 0;
+    size_t o = 0;
+
+    while (i < size) {
+        if (data[i] < 0x80) {
+            size_t run = NarrowAscii(data + i, size - i, dst + o);
+            i += run;
+            o += run;
+            while (i < size && data[i] < 0x80) {
+                dst[o++] = static_cast<char>(data[i++]);
+            }
+            continue;
+        }
+
+        uint32_t cp = data[i++];
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            if (i < size && data[i] >= 0xDC00 && data[i] <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (data[i++] - 0xDC00);
+            } else {
+                cp = kReplacementChar;
+            }
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            cp = kReplacementChar;
+        }
+
+        if (cp < 0x800) {
+            dst[o++] = static_cast<char>(0xC0 | (cp >> 6));
+            dst[o++] = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            dst[o++] = static_cast<char>(0xE0 | (cp >> 12));
+            dst[o++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            dst[o++] = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            dst[o++] = static_cast<char>(0xF0 | (cp >> 18));
+            dst[o++] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            dst[o++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            dst[o++] = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    out.resize(o);
+}
+
+std::string Utf16ToUtf8(const char16_t* data, size_t size) {
+    std::string out;
+    Utf16ToUtf8(data, size, out);
+    return out;
+}
+
+void Utf16LeToUtf8(const uint8_t* data, size_t size, std::string& out) {
+    std::u16string& units = ThreadWideScratch().data;
+    size_t count = size / 2;
+    units.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        units[i] = static_cast<char16_t>(data[2 * i] | (data[2 * i + 1] << 8));
+    }
+    Utf16ToUtf8(units.data(), count, out);
+}
+
+WideScratch& ThreadWideScratch() {
+    thread_local WideScratch scratch;
+    return scratch;
+}
+
+void EnsureWideSize(std::u16string& buffer, size_t units) {
+    if (buffer.size() < units) {
+        buffer.resize(units);
+    }
+}
+
+} // namespace registry
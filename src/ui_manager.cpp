@@ -7,8 +7,12 @@
 namespace ui {
 
 UIManager::UIManager() 
-    : registry_manager_(registry::RegistryManager::Create()),
-      current_path_("HKEY_LOCAL_MACHINE\\SOFTWARE"),
+    : UIManager(registry::RegistryManager::Create(), "HKEY_LOCAL_MACHINE\\SOFTWARE") {
+}
+
+UIManager::UIManager(std::unique_ptr<registry::RegistryManager> registryManager, std::string startPath)
+    : registry_manager_(std::move(registryManager)),
+      current_key_(registry_manager_->Paths().Intern(startPath)),
       current_view_(View::Keys),
       screen_(ftxui::ScreenInteractive::Fullscreen()) {
     InitializeUI();
@@ -36,13 +40,26 @@ ftxui::Component UIManager::CreateMainLayout() {
         status_bar,
         help_bar
     });
+
+    // Global key bindings
+    layout |= ftxui::CatchEvent([&](ftxui::Event event) {
+        if (event == ftxui::Event::F6) {
+            SaveChanges();
+            return true;
+        }
+        if (event == ftxui::Event::F10) {
+            RequestExit();
+            return true;
+        }
+        return false;
+    });
     
     return layout;
 }
 
 ftxui::Component UIManager::CreateNavigationPanel() {
     // Get subkeys for the current path
-    auto subkeys = registry_manager_->GetSubkeys(current_path_);
+    auto subkeys = registry_manager_->GetSubkeys(current_key_);
     
     // Create a list of menu entries
     std::vector<std::string> entries;
@@ -83,7 +100,7 @@ ftxui::Component UIManager::CreateNavigationPanel() {
 
 ftxui::Component UIManager::CreateContentPanel() {
     // Get values for the current path
-    auto values = registry_manager_->GetValues(current_path_);
+    auto values = registry_manager_->GetValues(current_key_);
     
     // Create a table with name, type, and data columns
     std::vector<std::string> names;
@@ -151,7 +168,8 @@ ftxui::Component UIManager::CreateStatusBar() {
     return ftxui::Renderer([&] {
         return ftxui::hbox({
             ftxui::text("Path: ") | ftxui::bold,
-            ftxui::text(current_path_)
+            ftxui::text(CurrentPath()) | ftxui::flex,
+            ftxui::text(status_message_)
         }) | ftxui::border;
     });
 }
@@ -169,22 +187,36 @@ ftxui::Component UIManager::CreateHelpBar() {
             ftxui::text(" | "),
             ftxui::text("F5:Refresh") | ftxui::bold,
             ftxui::text(" | "),
+            ftxui::text("F6:Save") | ftxui::bold,
+            ftxui::text(" | "),
             ftxui::text("F10:Exit") | ftxui::bold
         }) | ftxui::border;
     });
 }
 
+const std::string& UIManager::CurrentPath() const {
+    return registry_manager_->Paths().Path(current_key_);
+}
+
 void UIManager::NavigateToParent() {
-    size_t pos = current_path_.find_last_of('\\');
-    if (pos != std::string::npos) {
-        current_path_ = current_path_.substr(0, pos);
-        RefreshCurrentView();
+    // The root of a mounted namespace has no parent
+    if (current_key_ == registry::kRootKeyId) {
+        return;
+    }
+
+    // Stay put if the parent lists nothing, e.g. a backend without a
+    // browsable root; otherwise ".." would lead to a dead end
+    registry::KeyId parent = registry_manager_->Paths().Parent(current_key_);
+    if (parent == registry::kRootKeyId && registry_manager_->GetSubkeys(parent).empty()) {
+        return;
     }
+    current_key_ = parent;
+    RefreshCurrentView();
 }
 
 void UIManager::NavigateToChild(const std::string& child) {
     if (child != "..") {
-        current_path_ += "\\" + child;
+        current_key_ = registry_manager_->Paths().Child(current_key_, child);
         RefreshCurrentView();
     }
 }
@@ -192,13 +224,13 @@ void UIManager::NavigateToChild(const std::string& child) {
 void UIManager::RefreshCurrentView() {
     // This would rebuild the UI components
     // For now, we'll just print to console for debugging
-    std::cout << "Refreshing view for path: " << current_path_ << std::endl;
+    std::cout << "Refreshing view for path: " << CurrentPath() << std::endl;
 }
 
 void UIManager::CreateNewKey() {
     // This would show a dialog to create a new key
     // For now, we'll just print to console for debugging
-    std::cout << "Creating new key in: " << current_path_ << std::endl;
+    std::cout << "Creating new key in: " << CurrentPath() << std::endl;
 }
 
 void UIManager::DeleteSelectedKey() {
@@ -210,7 +242,7 @@ void UIManager::DeleteSelectedKey() {
 void UIManager::CreateNewValue() {
     // This would show a dialog to create a new value
     // For now, we'll just print to console for debugging
-    std::cout << "Creating new value in: " << current_path_ << std::endl;
+    std::cout << "Creating new value in: " << CurrentPath() << std::endl;
 }
 
 void UIManager::EditSelectedValue() {
@@ -234,7 +266,7 @@ void UIManager::ImportRegistry() {
 void UIManager::ExportRegistry() {
     // This would show a dialog to export registry data
     // For now, we'll just print to console for debugging
-    std::cout << "Exporting registry data from: " << current_path_ << std::endl;
+    std::cout << "Exporting registry data from: " << CurrentPath() << std::endl;
 }
 
 void UIManager::SearchRegistry() {
@@ -243,4 +275,20 @@ void UIManager::SearchRegistry() {
     std::cout << "Searching registry" << std::endl;
 }
 
+void UIManager::SaveChanges() {
+    // Offline hives stage their changes until saved; the live registry
+    // applies them immediately
+    exit_pending_ = false;
+    status_message_ = registry_manager_->Save() ? "Changes saved" : "Error: could not save all changes";
+}
+
+void UIManager::RequestExit() {
+    if (registry_manager_->HasUnsavedChanges() && !exit_pending_) {
+        exit_pending_ = true;
+        status_message_ = "Unsaved changes: F6 to save, F10 again to exit without saving";
+        return;
+    }
+    screen_.ExitLoopClosure()();
+}
+
 } // namespace ui
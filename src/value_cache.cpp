@@ -0,0 +1,129 @@
+#include "value_cache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace registry {
+
+ChunkCache::ChunkCache(size_t budget)
+    : budget_(budget) {
+}
+
+ChunkCache::Chunk ChunkCache::Find(const ValueIdentity& owner, size_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find({owner, index});
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->chunk;
+}
+
+void ChunkCache::Insert(const ValueIdentity& owner, size_t index, Chunk chunk) {
+    if (!chunk) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (chunk->size() > budget_) {
+        return;
+    }
+
+    EntryKey key{owner, index};
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        bytes_ -= it->second->chunk->size();
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    bytes_ += chunk->size();
+    entries_.push_front({key, std::move(chunk)});
+    index_[key] = entries_.begin();
+    Evict();
+}
+
+void ChunkCache::SetBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    Evict();
+}
+
+size_t ChunkCache::Budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+size_t ChunkCache::Bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+// Helper methods
+size_t ChunkCache::EntryKeyHash::operator()(const EntryKey& key) const {
+    // Boost-style combine over the numeric fields. `name` is left out, as
+    // `item` already hashes it; keys are compared in full, names included,
+    // so collisions only cost a probe
+    uint64_t hash = key.owner.source;
+    for (uint64_t part : {key.owner.version, key.owner.item, static_cast<uint64_t>(key.index)}) {
+        hash ^= part + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    }
+    return static_cast<size_t>(hash);
+}
+
+void ChunkCache::Evict() {
+    while (bytes_ > budget_ && !entries_.empty()) {
+        const Entry& victim = entries_.back();
+        bytes_ -= victim.chunk->size();
+        index_.erase(victim.key);
+        entries_.pop_back();
+    }
+}
+
+CachedLargeValue::CachedLargeValue(size_t size, const ValueIdentity& identity,
+                                   std::shared_ptr<ChunkCache> cache)
+    : size_(size), identity_(identity), cache_(std::move(cache)) {
+}
+
+size_t CachedLargeValue::ReadChunk(size_t offset, uint8_t* out, size_t size) const {
+    size_t copied = 0;
+    std::vector<uint8_t> loaded;
+    while (copied < size && offset < size_) {
+        size_t index = offset / kValueChunkSize;
+        size_t inChunk = offset % kValueChunkSize;
+
+        ChunkCache::Chunk chunk = cache_ ? cache_->Find(identity_, index) : nullptr;
+        const std::vector<uint8_t>* data = chunk.get();
+        if (!data) {
+            if (!LoadChunk(index, loaded)) {
+                break;
+            }
+            data = &loaded;
+            if (cache_) {
+                chunk = std::make_shared<const std::vector<uint8_t>>(std::move(loaded));
+                cache_->Insert(identity_, index, chunk);
+                data = chunk.get();
+            }
+        }
+        if (inChunk >= data->size()) {
+            break;
+        }
+
+        size_t take = std::min(size - copied, data->size() - inChunk);
+        std::memcpy(out + copied, data->data() + inChunk, take);
+        copied += take;
+        offset += take;
+    }
+    return copied;
+}
+
+void CachedLargeValue::StoreChunk(size_t index, std::vector<uint8_t> data) const {
+    if (cache_) {
+        cache_->Insert(identity_, index, std::make_shared<const std::vector<uint8_t>>(std::move(data)));
+    }
+}
+
+size_t CachedLargeValue::CacheBudget() const {
+    return cache_ ? cache_->Budget() : 0;
+}
+
+} // namespace registry
@@ -0,0 +1,249 @@
+#include "value_codec.h"
+#include "text_encoding.h"
+
+namespace registry {
+
+namespace {
+
+// Raw REG_* type codes
+enum RawType : uint32_t {
+    kRawNone = 0,
+    kRawSz = 1,
+    kRawExpandSz = 2,
+    kRawBinary = 3,
+    kRawDword = 4,
+    kRawDwordBigEndian = 5,
+    kRawLink = 6,
+    kRawMultiSz = 7,
+    kRawResourceList = 8,
+    kRawQword = 11
+};
+
+// Length in bytes of a UTF-16LE string up to (not including) the first NUL
+size_t Utf16LeLength(const uint8_t* data, size_t size) {
+    size_t length = 0;
+    while (length + 1 < size && (data[length] | data[length + 1]) != 0) {
+        length += 2;
+    }
+    return length;
+}
+
+// Read up to sizeof(T) little-endian bytes; missing high bytes are zero
+template <typename T>
+T ReadLittleEndian(const uint8_t* data, size_t size) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T) && i < size; ++i) {
+        value |= static_cast<T>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+template <typename T>
+void AppendLittleEndian(T value, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void AppendUtf16Le(const std::string& str, std::vector<uint8_t>& out) {
+    std::u16string& units = ThreadWideScratch().data;
+    Utf8ToUtf16(str, units);
+    out.reserve(out.size() + (units.size() + 1) * 2);
+    for (char16_t unit : units) {
+        out.push_back(static_cast<uint8_t>(unit));
+        out.push_back(static_cast<uint8_t>(unit >> 8));
+    }
+    out.push_back(0);
+    out.push_back(0);
+}
+
+} // namespace
+
+ValueType ValueTypeFromRaw(uint32_t raw) {
+    switch (raw) {
+        case kRawNone: return ValueType::REG_NONE;
+        case kRawSz: return ValueType::REG_SZ;
+        case kRawExpandSz: return ValueType::REG_EXPAND_SZ;
+        case kRawBinary: return ValueType::REG_BINARY;
+        case kRawDword: return ValueType::REG_DWORD;
+        case kRawDwordBigEndian: return ValueType::REG_DWORD_BIG_ENDIAN;
+        case kRawLink: return ValueType::REG_LINK;
+        case kRawMultiSz: return ValueType::REG_MULTI_SZ;
+        case kRawResourceList: return ValueType::REG_RESOURCE_LIST;
+        case kRawQword: return ValueType::REG_QWORD;
+        default: return ValueType::UNKNOWN;
+    }
+}
+
+uint32_t ValueTypeToRaw(ValueType type) {
+    switch (type) {
+        case ValueType::REG_NONE: return kRawNone;
+        case ValueType::REG_SZ: return kRawSz;
+        case ValueType::REG_EXPAND_SZ: return kRawExpandSz;
+        case ValueType::REG_BINARY: return kRawBinary;
+        case ValueType::REG_DWORD: return kRawDword;
+        case ValueType::REG_DWORD_BIG_ENDIAN: return kRawDwordBigEndian;
+        case ValueType::REG_LINK: return kRawLink;
+        case ValueType::REG_MULTI_SZ: return kRawMultiSz;
+        case ValueType::REG_RESOURCE_LIST: return kRawResourceList;
+        case ValueType::REG_QWORD: return kRawQword;
+        default: return kRawNone;
+    }
+}
+
+uint32_t RawValueType(const Value& value) {
+    return value.type == ValueType::UNKNOWN ? value.rawType : ValueTypeToRaw(value.type);
+}
+
+void DecodeValueData(ValueType type, const uint8_t* data, size_t size, ValueData& out) {
+    if (data == nullptr) {
+        size = 0;
+    }
+
+    switch (type) {
+        case ValueType::REG_SZ:
+        case ValueType::REG_EXPAND_SZ: {
+            // Stored strings are usually, but not always, NUL-terminated
+            std::string* str = std::get_if<std::string>(&out);
+            if (str == nullptr) {
+                str = &out.emplace<std::string>();
+            }
+            Utf16LeToUtf8(data, Utf16LeLength(data, size), *str);
+            return;
+        }
+
+        case ValueType::REG_DWORD:
+            out = ReadLittleEndian<uint32_t>(data, size);
+            return;
+
+        case ValueType::REG_DWORD_BIG_ENDIAN: {
+            uint32_t value = 0;
+            for (size_t i = 0; i < sizeof(value); ++i) {
+                value = (value << 8) | (i < size ? data[i] : 0);
+            }
+            out = value;
+            return;
+        }
+
+        case ValueType::REG_QWORD:
+            out = ReadLittleEndian<uint64_t>(data, size);
+            return;
+
+        case ValueType::REG_MULTI_SZ: {
+            // A list of NUL-terminated strings ending with an empty string.
+            // The final terminator (or both) may be missing.
+            auto* strings = std::get_if<std::vector<std::string>>(&out);
+            if (strings == nullptr) {
+                strings = &out.emplace<std::vector<std::string>>();
+            }
+            strings->clear();
+
+            size_t offset = 0;
+            size = size & ~static_cast<size_t>(1);
+            while (offset < size) {
+                size_t length = Utf16LeLength(data + offset, size - offset);
+                if (length == 0) {
+                    break;
+                }
+                strings->emplace_back();
+                Utf16LeToUtf8(data + offset, length, strings->back());
+                offset += length + 2;
+            }
+            return;
+        }
+
+        default: {
+            // REG_BINARY, REG_NONE, the structured types and unmapped
+            // types are kept as raw bytes
+            auto* bytes = std::get_if<std::vector<uint8_t>>(&out);
+            if (bytes == nullptr) {
+                bytes = &out.emplace<std::vector<uint8_t>>();
+            }
+            bytes->assign(data, data + size);
+            return;
+        }
+    }
+}
+
+ValueData DecodeValueData(ValueType type, const uint8_t* data, size_t size) {
+    ValueData out;
+    DecodeValueData(type, data, size, out);
+    return out;
+}
+
+bool EncodeValueData(const Value& value, std::vector<uint8_t>& out) {
+    out.clear();
+
+    // `data` of a large value is empty; encoding it would store 0 bytes
+    if (value.large) {
+        return false;
+    }
+
+    switch (value.type) {
+        case ValueType::REG_SZ:
+        case ValueType::REG_EXPAND_SZ: {
+            const auto* str = std::get_if<std::string>(&value.data);
+            if (str == nullptr) {
+                return false;
+            }
+            AppendUtf16Le(*str, out);
+            return true;
+        }
+
+        case ValueType::REG_DWORD: {
+            const auto* number = std::get_if<uint32_t>(&value.data);
+            if (number == nullptr) {
+                return false;
+            }
+            AppendLittleEndian(*number, out);
+            return true;
+        }
+
+        case ValueType::REG_DWORD_BIG_ENDIAN: {
+            const auto* number = std::get_if<uint32_t>(&value.data);
+            if (number == nullptr) {
+                return false;
+            }
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                out.push_back(static_cast<uint8_t>(*number >> shift));
+            }
+            return true;
+        }
+
+        case ValueType::REG_QWORD: {
+            const auto* number = std::get_if<uint64_t>(&value.data);
+            if (number == nullptr) {
+                return false;
+            }
+            AppendLittleEndian(*number, out);
+            return true;
+        }
+
+        case ValueType::REG_MULTI_SZ: {
+            const auto* strings = std::get_if<std::vector<std::string>>(&value.data);
+            if (strings == nullptr) {
+                return false;
+            }
+            for (const auto& str : *strings) {
+                AppendUtf16Le(str, out);
+            }
+            out.push_back(0);
+            out.push_back(0);
+            return true;
+        }
+
+        default: {
+            if (std::holds_alternative<std::monostate>(value.data)) {
+                return true;
+            }
+            const auto* bytes = std::get_if<std::vector<uint8_t>>(&value.data);
+            if (bytes == nullptr) {
+                return false;
+            }
+            out = *bytes;
+            return true;
+        }
+    }
+}
+
+} // namespace registry
@@ -1,12 +1,174 @@
 #ifdef PLATFORM_WINDOWS
 #include "windows_registry_manager.h"
+#include "parallel_range.h"
+#include "text_encoding.h"
+#include "value_cache.h"
+#include "value_codec.h"
 #include <windows.h>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <mutex>
 
 namespace registry {
 
+static_assert(sizeof(wchar_t) == sizeof(char16_t), "Win32 wide strings must be UTF-16");
+
+namespace {
+
+// View a UTF-16 buffer as a Win32 wide string
+const wchar_t* AsWide(const std::u16string& str) {
+    return reinterpret_cast<const wchar_t*>(str.c_str());
+}
+
+wchar_t* AsWide(std::u16string& str) {
+    return reinterpret_cast<wchar_t*>(&str[0]);
+}
+
+// Subkey and value maxima reported by RegQueryInfoKeyW (lengths in
+// characters, excluding the terminator)
+struct KeyInfo {
+    DWORD subkeyCount = 0;
+    DWORD maxSubkeyNameLength = 0;
+    DWORD valueCount = 0;
+    DWORD maxValueNameLength = 0;
+    DWORD maxValueDataSize = 0;
+    FILETIME lastWriteTime = {};  // advances when a value of the key changes
+};
+
+// The predefined keys listed at the root path ""
+const char* const kPredefinedKeys[] = {
+    "HKEY_CLASSES_ROOT",
+    "HKEY_CURRENT_USER",
+    "HKEY_LOCAL_MACHINE",
+    "HKEY_USERS",
+    "HKEY_CURRENT_CONFIG",
+};
+
+bool QueryKeyInfo(HKEY hKey, KeyInfo& info) {
+    LONG result = RegQueryInfoKeyW(hKey, NULL, NULL, NULL,
+                                   &info.subkeyCount, &info.maxSubkeyNameLength, NULL,
+                                   &info.valueCount, &info.maxValueNameLength, &info.maxValueDataSize,
+                                   NULL, &info.lastWriteTime);
+    return result == ERROR_SUCCESS;
+}
+
+// Temporary file holding a copy of `data`, deleted when its handle is
+// closed. Returns INVALID_HANDLE_VALUE on failure.
+HANDLE CreateSpillFile(const std::vector<uint8_t>& data) {
+    wchar_t directory[MAX_PATH + 1];
+    wchar_t path[MAX_PATH + 1];
+    DWORD length = GetTempPathW(MAX_PATH + 1, directory);
+    if (length == 0 || length > MAX_PATH || GetTempFileNameW(directory, L"reg", 0, path) == 0) {
+        return INVALID_HANDLE_VALUE;
+    }
+    HANDLE file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        DeleteFileW(path);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    for (size_t offset = 0; offset < data.size();) {
+        DWORD written = 0;
+        if (!WriteFile(file, data.data() + offset, static_cast<DWORD>(data.size() - offset), &written, NULL) ||
+            written == 0) {
+            CloseHandle(file);
+            return INVALID_HANDLE_VALUE;
+        }
+        offset += written;
+    }
+    return file;
+}
+
+bool ReadSpillFile(HANDLE file, size_t offset, std::vector<uint8_t>& out) {
+    OVERLAPPED position = {};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+    DWORD read = 0;
+    return ReadFile(file, out.data(), static_cast<DWORD>(out.size()), &read, &position) && read == out.size();
+}
+
+// Handle to a large value. RegQueryValueExW cannot read part of a value,
+// so the first cache miss reads the whole value once. If it fits in the
+// cache, all of its chunks are cached; otherwise it is copied to a
+// temporary file that serves later misses, so reading a value costs one
+// registry read whatever the cache size.
+class WindowsLargeValue : public CachedLargeValue {
+public:
+    WindowsLargeValue(HKEY root, std::u16string subKey, std::u16string valueName, size_t size,
+                      const ValueIdentity& identity, std::shared_ptr<ChunkCache> cache)
+        : CachedLargeValue(size, identity, std::move(cache)), root_(root),
+          sub_key_(std::move(subKey)), value_name_(std::move(valueName)) {
+    }
+
+    ~WindowsLargeValue() override {
+        if (spill_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(spill_);
+        }
+    }
+
+protected:
+    bool LoadChunk(size_t index, std::vector<uint8_t>& out) const override {
+        size_t offset = index * kValueChunkSize;
+        if (offset >= Size()) {
+            return false;
+        }
+        out.resize(std::min(kValueChunkSize, Size() - offset));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (spill_ != INVALID_HANDLE_VALUE) {
+            return ReadSpillFile(spill_, offset, out);
+        }
+
+        std::vector<uint8_t> data;
+        if (!ReadValue(data)) {
+            return false;
+        }
+        std::copy(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                  data.begin() + static_cast<std::ptrdiff_t>(offset + out.size()), out.begin());
+
+        if (data.size() > CacheBudget()) {
+            // If the copy fails, later misses read the value again
+            spill_ = CreateSpillFile(data);
+            return true;
+        }
+        for (size_t begin = 0, i = 0; begin < data.size(); begin += kValueChunkSize, ++i) {
+            if (i != index) {
+                size_t end = std::min(begin + kValueChunkSize, data.size());
+                StoreChunk(i, std::vector<uint8_t>(data.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                   data.begin() + static_cast<std::ptrdiff_t>(end)));
+            }
+        }
+        return true;
+    }
+
+private:
+    bool ReadValue(std::vector<uint8_t>& data) const {
+        HKEY hKey;
+        if (RegOpenKeyExW(root_, AsWide(sub_key_), 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+            return false;
+        }
+        data.resize(Size());
+        DWORD dataSize = static_cast<DWORD>(data.size());
+        LONG result = RegQueryValueExW(hKey, AsWide(value_name_), NULL, NULL, data.data(), &dataSize);
+        RegCloseKey(hKey);
+        // Fails if the value changed since it was enumerated
+        return result == ERROR_SUCCESS && dataSize == data.size();
+    }
+
+    HKEY root_;  // predefined root key, never closed
+    std::u16string sub_key_;
+    std::u16string value_name_;
+
+    mutable std::mutex mutex_;
+    mutable HANDLE spill_ = INVALID_HANDLE_VALUE;
+};
+
+} // namespace
+
 WindowsRegistryManager::WindowsRegistryManager() {
     // Constructor implementation
 }
@@ -16,14 +178,15 @@ WindowsRegistryManager::~WindowsRegistryManager() {
 }
 
 std::optional<Key> WindowsRegistryManager::OpenKey(const std::string& path) {
-    auto [hRootKey, subKey] = ParseRegistryPath(path);
-    if (hRootKey == NULL) {
-        return std::nullopt;
+    // The root has no handle of its own; it only holds the predefined keys
+    if (path.empty()) {
+        Key key;
+        key.subkeys = GetSubkeys(path);
+        return key;
     }
 
-    HKEY hKey;
-    LONG result = RegOpenKeyExA(hRootKey, subKey.c_str(), 0, KEY_READ, &hKey);
-    if (result != ERROR_SUCCESS) {
+    HKEY hKey = OpenKeyHandle(path, KEY_READ);
+    if (hKey == NULL) {
         return std::nullopt;
     }
 
@@ -38,66 +201,150 @@ std::optional<Key> WindowsRegistryManager::OpenKey(const std::string& path) {
 }
 
 std::vector<Value> WindowsRegistryManager::GetValues(const std::string& path) {
-    auto [hRootKey, subKey] = ParseRegistryPath(path);
-    if (hRootKey == NULL) {
+    HKEY hKey = OpenKeyHandle(path, KEY_READ);
+    if (hKey == NULL) {
         return {};
     }
 
-    HKEY hKey;
-    LONG result = RegOpenKeyExA(hRootKey, subKey.c_str(), 0, KEY_READ, &hKey);
-    if (result != ERROR_SUCCESS) {
+    KeyInfo info;
+    if (!QueryKeyInfo(hKey, info)) {
+        RegCloseKey(hKey);
         return {};
     }
 
-    std::vector<Value> values;
-    
-    char valueName[256];
-    DWORD valueNameSize = sizeof(valueName);
-    DWORD valueType;
+    std::vector<Value> values(info.valueCount);
+
+    // Values above the threshold are not read here, so the data buffer
+    // never needs to exceed it. The data that is read counts against the
+    // chunk cache budget; once it would be exceeded, the remaining values
+    // are returned as handles too.
+    size_t threshold = value_limits_.largeValueThreshold;
+    size_t eagerBytes = 0;
+    size_t dataCapacity = info.maxValueDataSize;
+    if (threshold != 0) {
+        dataCapacity = std::min(dataCapacity, threshold);
+    }
+
+    // Name and data buffers are sized once from the key's maxima, so each
+    // value costs a single RegEnumValueW call. They only grow if a longer
+    // value is written while we enumerate.
+    WideScratch& scratch = ThreadWideScratch();
+    std::u16string& valueName = scratch.name;
+    std::vector<uint8_t>& data = scratch.bytes;
+    EnsureWideSize(valueName, info.maxValueNameLength + 1);
+    if (data.size() < dataCapacity || data.empty()) {
+        data.resize(std::max<size_t>(dataCapacity, 1));
+    }
+
     DWORD valueIndex = 0;
+    for (;;) {
+        size_t limit = threshold != 0 ? std::min(threshold, value_limits_.chunkCacheBytes - eagerBytes) : data.size();
+        DWORD valueNameSize = static_cast<DWORD>(valueName.size());
+        DWORD dataSize = static_cast<DWORD>(std::min(data.size(), limit));
+        DWORD valueType;
+        LONG result = RegEnumValueW(hKey, valueIndex, AsWide(valueName), &valueNameSize, NULL,
+                                    &valueType, data.data(), &dataSize);
+        bool large = false;
+        if (result == ERROR_MORE_DATA && threshold != 0 && dataSize > limit) {
+            // Too large to load eagerly: fetch just the name, type and size
+            valueNameSize = static_cast<DWORD>(valueName.size());
+            result = RegEnumValueW(hKey, valueIndex, AsWide(valueName), &valueNameSize, NULL,
+                                   &valueType, NULL, &dataSize);
+            large = result == ERROR_SUCCESS;
+        }
+        if (result == ERROR_MORE_DATA) {
+            if (dataSize > data.size() && (threshold == 0 || dataSize <= limit)) {
+                data.resize(dataSize);
+            } else {
+                EnsureWideSize(valueName, valueName.size() * 2);
+            }
+            continue;
+        }
+        if (result != ERROR_SUCCESS) {
+            break;
+        }
 
-    while (RegEnumValueA(hKey, valueIndex, valueName, &valueNameSize, NULL, &valueType, NULL, NULL) == ERROR_SUCCESS) {
-        Value value;
-        value.name = valueName;
+        if (valueIndex >= values.size()) {
+            values.emplace_back();
+        }
+        Value& value = values[valueIndex];
+        Utf16ToUtf8(valueName.data(), valueNameSize, value.name);
         value.type = GetValueType(valueType);
-        value.data = ReadValueData(hKey, valueName, value.type);
-        
-        values.push_back(value);
-        
-        valueNameSize = sizeof(valueName);
+        value.rawType = valueType;
+        if (large) {
+            auto [hRootKey, subKey] = ParseRegistryPath(path);
+            std::u16string wideSubKey;
+            Utf8ToUtf16(subKey, wideSubKey);
+
+            // Handles to the same value share cached chunks until the key
+            // is next written
+            ValueIdentity identity;
+            identity.source = reinterpret_cast<uintptr_t>(hRootKey);
+            identity.version = (static_cast<uint64_t>(info.lastWriteTime.dwHighDateTime) << 32) |
+                               info.lastWriteTime.dwLowDateTime;
+            identity.name = FoldCase(subKey);
+            identity.name.push_back('\0');  // never part of a key path
+            AppendFoldedCase(value.name, identity.name);
+            identity.item = std::hash<std::string>()(identity.name);
+
+            value.data = std::monostate{};
+            value.large = std::make_shared<WindowsLargeValue>(
+                hRootKey, std::move(wideSubKey), std::u16string(valueName.data(), valueNameSize),
+                dataSize, identity, chunk_cache_);
+        } else {
+            DecodeValueData(value.type, data.data(), dataSize, value.data);
+            eagerBytes += dataSize;
+        }
+
         valueIndex++;
     }
+    values.resize(valueIndex);
 
     RegCloseKey(hKey);
     return values;
 }
 
 std::vector<std::string> WindowsRegistryManager::GetSubkeys(const std::string& path) {
-    auto [hRootKey, subKey] = ParseRegistryPath(path);
-    if (hRootKey == NULL) {
+    if (path.empty()) {
+        return std::vector<std::string>(std::begin(kPredefinedKeys), std::end(kPredefinedKeys));
+    }
+
+    HKEY hKey = OpenKeyHandle(path, KEY_READ);
+    if (hKey == NULL) {
         return {};
     }
 
-    HKEY hKey;
-    LONG result = RegOpenKeyExA(hRootKey, subKey.c_str(), 0, KEY_READ, &hKey);
-    if (result != ERROR_SUCCESS) {
+    KeyInfo info;
+    if (!QueryKeyInfo(hKey, info)) {
+        RegCloseKey(hKey);
         return {};
     }
 
     std::vector<std::string> subkeys;
-    
-    char keyName[256];
-    DWORD keyNameSize = sizeof(keyName);
-    DWORD keyIndex = 0;
-
-    while (RegEnumKeyExA(hKey, keyIndex, keyName, &keyNameSize, NULL, NULL, NULL, NULL) == ERROR_SUCCESS) {
-        subkeys.push_back(keyName);
-        keyNameSize = sizeof(keyName);
-        keyIndex++;
+    const ParallelEnumeration& parallel = GetParallelEnumeration();
+    if (parallel.threshold == 0 || info.subkeyCount < parallel.threshold) {
+        subkeys.reserve(info.subkeyCount);
+        EnumerateSubkeys(hKey, 0, MAXDWORD, info.maxSubkeyNameLength, subkeys);
+        RegCloseKey(hKey);
+        return subkeys;
     }
-
     RegCloseKey(hKey);
-    return subkeys;
+
+    // Registry handles serialize enumeration, so each worker opens its own.
+    // The last range stays open-ended to pick up keys added meanwhile.
+    DWORD count = info.subkeyCount;
+    return EnumerateInParallel<std::string>(count, parallel.maxThreads,
+        [&](size_t begin, size_t end, std::vector<std::string>& out) {
+            HKEY hWorkerKey = OpenKeyHandle(path, KEY_READ);
+            if (hWorkerKey == NULL) {
+                return;
+            }
+            out.reserve(end - begin);
+            EnumerateSubkeys(hWorkerKey, static_cast<DWORD>(begin),
+                             end == count ? MAXDWORD : static_cast<DWORD>(end),
+                             info.maxSubkeyNameLength, out);
+            RegCloseKey(hWorkerKey);
+        });
 }
 
 bool WindowsRegistryManager::CreateKey(const std::string& path) {
@@ -106,9 +353,12 @@ bool WindowsRegistryManager::CreateKey(const std::string& path) {
         return false;
     }
 
+    std::u16string& wideSubKey = ThreadWideScratch().path;
+    Utf8ToUtf16(subKey, wideSubKey);
+
     HKEY hKey;
     DWORD disposition;
-    LONG result = RegCreateKeyExA(hRootKey, subKey.c_str(), 0, NULL, 0, KEY_WRITE, NULL, &hKey, &disposition);
+    LONG result = RegCreateKeyExW(hRootKey, AsWide(wideSubKey), 0, NULL, 0, KEY_WRITE, NULL, &hKey, &disposition);
     if (result != ERROR_SUCCESS) {
         return false;
     }
@@ -123,78 +373,27 @@ bool WindowsRegistryManager::DeleteKey(const std::string& path) {
         return false;
     }
 
-    LONG result = RegDeleteKeyA(hRootKey, subKey.c_str());
+    std::u16string& wideSubKey = ThreadWideScratch().path;
+    Utf8ToUtf16(subKey, wideSubKey);
+
+    LONG result = RegDeleteKeyW(hRootKey, AsWide(wideSubKey));
     return result == ERROR_SUCCESS;
 }
 
 bool WindowsRegistryManager::SetValue(const std::string& path, const Value& value) {
-    auto [hRootKey, subKey] = ParseRegistryPath(path);
-    if (hRootKey == NULL) {
+    HKEY hKey = OpenKeyHandle(path, KEY_WRITE);
+    if (hKey == NULL) {
         return false;
     }
 
-    HKEY hKey;
-    LONG result = RegOpenKeyExA(hRootKey, subKey.c_str(), 0, KEY_WRITE, &hKey);
-    if (result != ERROR_SUCCESS) {
-        return false;
-    }
+    WideScratch& scratch = ThreadWideScratch();
+    Utf8ToUtf16(value.name, scratch.name);
 
     bool success = false;
-    DWORD winType = GetWinType(value.type);
-
-    switch (value.type) {
-        case ValueType::REG_SZ:
-        case ValueType::REG_EXPAND_SZ: {
-            const std::string& str = std::get<std::string>(value.data);
-            result = RegSetValueExA(hKey, value.name.c_str(), 0, winType, 
-                                   reinterpret_cast<const BYTE*>(str.c_str()), 
-                                   static_cast<DWORD>(str.size() + 1));
-            success = (result == ERROR_SUCCESS);
-            break;
-        }
-        case ValueType::REG_BINARY: {
-            const auto& data = std::get<std::vector<uint8_t>>(value.data);
-            result = RegSetValueExA(hKey, value.name.c_str(), 0, winType, 
-                                   data.data(), 
-                                   static_cast<DWORD>(data.size()));
-            success = (result == ERROR_SUCCESS);
-            break;
-        }
-        case ValueType::REG_DWORD:
-        case ValueType::REG_DWORD_BIG_ENDIAN: {
-            uint32_t data = std::get<uint32_t>(value.data);
-            result = RegSetValueExA(hKey, value.name.c_str(), 0, winType, 
-                                   reinterpret_cast<const BYTE*>(&data), 
-                                   sizeof(data));
-            success = (result == ERROR_SUCCESS);
-            break;
-        }
-        case ValueType::REG_QWORD: {
-            uint64_t data = std::get<uint64_t>(value.data);
-            result = RegSetValueExA(hKey, value.name.c_str(), 0, winType, 
-                                   reinterpret_cast<const BYTE*>(&data), 
-                                   sizeof(data));
-            success = (result == ERROR_SUCCESS);
-            break;
-        }
-        case ValueType::REG_MULTI_SZ: {
-            const auto& strings = std::get<std::vector<std::string>>(value.data);
-            std::string combined;
-            for (const auto& str : strings) {
-                combined += str;
-                combined.push_back('\0');
-            }
-            combined.push_back('\0');
-            
-            result = RegSetValueExA(hKey, value.name.c_str(), 0, winType, 
-                                   reinterpret_cast<const BYTE*>(combined.c_str()), 
-                                   static_cast<DWORD>(combined.size()));
-            success = (result == ERROR_SUCCESS);
-            break;
-        }
-        default:
-            success = false;
-            break;
+    if (EncodeValueData(value, scratch.bytes)) {
+        LONG result = RegSetValueExW(hKey, AsWide(scratch.name), 0, RawValueType(value),
+                                     scratch.bytes.data(), static_cast<DWORD>(scratch.bytes.size()));
+        success = (result == ERROR_SUCCESS);
     }
 
     RegCloseKey(hKey);
@@ -202,18 +401,15 @@ bool WindowsRegistryManager::SetValue(const std::string& path, const Value& valu
 }
 
 bool WindowsRegistryManager::DeleteValue(const std::string& path, const std::string& valueName) {
-    auto [hRootKey, subKey] = ParseRegistryPath(path);
-    if (hRootKey == NULL) {
+    HKEY hKey = OpenKeyHandle(path, KEY_WRITE);
+    if (hKey == NULL) {
         return false;
     }
 
-    HKEY hKey;
-    LONG result = RegOpenKeyExA(hRootKey, subKey.c_str(), 0, KEY_WRITE, &hKey);
-    if (result != ERROR_SUCCESS) {
-        return false;
-    }
+    std::u16string& wideName = ThreadWideScratch().name;
+    Utf8ToUtf16(valueName, wideName);
 
-    result = RegDeleteValueA(hKey, valueName.c_str());
+    LONG result = RegDeleteValueW(hKey, AsWide(wideName));
     RegCloseKey(hKey);
     
     return result == ERROR_SUCCESS;
@@ -247,6 +443,23 @@ std::pair<HKEY, std::string> WindowsRegistryManager::ParseRegistryPath(const std
     return {GetRootKeyHandle(rootKeyName), subKey};
 }
 
+HKEY WindowsRegistryManager::OpenKeyHandle(const std::string& path, REGSAM access) {
+    auto [hRootKey, subKey] = ParseRegistryPath(path);
+    if (hRootKey == NULL) {
+        return NULL;
+    }
+
+    std::u16string& wideSubKey = ThreadWideScratch().path;
+    Utf8ToUtf16(subKey, wideSubKey);
+
+    HKEY hKey;
+    LONG result = RegOpenKeyExW(hRootKey, AsWide(wideSubKey), 0, access, &hKey);
+    if (result != ERROR_SUCCESS) {
+        return NULL;
+    }
+    return hKey;
+}
+
 ValueType WindowsRegistryManager::GetValueType(DWORD winType) {
     switch (winType) {
         case REG_NONE: return ValueType::REG_NONE;
@@ -263,75 +476,25 @@ ValueType WindowsRegistryManager::GetValueType(DWORD winType) {
     }
 }
 
-DWORD WindowsRegistryManager::GetWinType(ValueType type) {
-    switch (type) {
-        case ValueType::REG_NONE: return REG_NONE;
-        case ValueType::REG_SZ: return REG_SZ;
-        case ValueType::REG_EXPAND_SZ: return REG_EXPAND_SZ;
-        case ValueType::REG_BINARY: return REG_BINARY;
-        case ValueType::REG_DWORD: return REG_DWORD;
-        case ValueType::REG_DWORD_BIG_ENDIAN: return REG_DWORD_BIG_ENDIAN;
-        case ValueType::REG_LINK: return REG_LINK;
-        case ValueType::REG_MULTI_SZ: return REG_MULTI_SZ;
-        case ValueType::REG_RESOURCE_LIST: return REG_RESOURCE_LIST;
-        case ValueType::REG_QWORD: return REG_QWORD;
-        default: return REG_NONE;
-    }
-}
-
-ValueData WindowsRegistryManager::ReadValueData(HKEY hKey, const std::string& valueName, ValueType type) {
-    DWORD dataSize = 0;
-    DWORD winType = GetWinType(type);
-    
-    // Get the data size
-    RegQueryValueExA(hKey, valueName.c_str(), NULL, &winType, NULL, &dataSize);
-    
-    switch (type) {
-        case ValueType::REG_NONE:
-            return std::monostate{};
-            
-        case ValueType::REG_SZ:
-        case ValueType::REG_EXPAND_SZ: {
-            std::vector<char> buffer(dataSize);
-            RegQueryValueExA(hKey, valueName.c_str(), NULL, &winType, reinterpret_cast<BYTE*>(buffer.data()), &dataSize);
-            return std::string(buffer.data());
+void WindowsRegistryManager::EnumerateSubkeys(HKEY hKey, DWORD begin, DWORD end, DWORD maxNameLength,
+                                              std::vector<std::string>& out) {
+    std::u16string& keyName = ThreadWideScratch().name;
+    EnsureWideSize(keyName, maxNameLength + 1);
+
+    DWORD keyIndex = begin;
+    while (keyIndex < end) {
+        DWORD keyNameSize = static_cast<DWORD>(keyName.size());
+        LONG result = RegEnumKeyExW(hKey, keyIndex, AsWide(keyName), &keyNameSize, NULL, NULL, NULL, NULL);
+        if (result == ERROR_MORE_DATA) {
+            EnsureWideSize(keyName, keyName.size() * 2);
+            continue;
         }
-            
-        case ValueType::REG_BINARY: {
-            std::vector<uint8_t> buffer(dataSize);
-            RegQueryValueExA(hKey, valueName.c_str(), NULL, &winType, buffer.data(), &dataSize);
-            return buffer;
-        }
-            
-        case ValueType::REG_DWORD:
-        case ValueType::REG_DWORD_BIG_ENDIAN: {
-            uint32_t value = 0;
-            RegQueryValueExA(hKey, valueName.c_str(), NULL, &winType, reinterpret_cast<BYTE*>(&value), &dataSize);
-            return value;
-        }
-            
-        case ValueType::REG_QWORD: {
-            uint64_t value = 0;
-            RegQueryValueExA(hKey, valueName.c_str(), NULL, &winType, reinterpret_cast<BYTE*>(&value), &dataSize);
-            return value;
-        }
-            
-        case ValueType::REG_MULTI_SZ: {
-            std::vector<char> buffer(dataSize);
-            RegQueryValueExA(hKey, valueName.c_str(), NULL, &winType, reinterpret_cast<BYTE*>(buffer.data()), &dataSize);
-            
-            std::vector<std::string> strings;
-            const char* ptr = buffer.data();
-            while (*ptr) {
-                strings.push_back(ptr);
-                ptr += strlen(ptr) + 1;
-            }
-            
-            return strings;
+        if (result != ERROR_SUCCESS) {
+            break;
         }
-            
-        default:
-            return std::monostate{};
+
+        out.push_back(Utf16ToUtf8(keyName.data(), keyNameSize));
+        keyIndex++;
     }
 }
 
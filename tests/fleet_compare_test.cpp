@@ -0,0 +1,117 @@
+#include "hive_test_support.h"
+#include "test_support.h"
+#include "fleet_compare.h"
+#include "hive_registry_manager.h"
+#include <memory>
+
+using namespace registry;
+
+namespace {
+
+const size_t kBlobSize = 100 * 1024;
+
+// Svc\Params with two values, a large blob and one subkey; `blobByte`
+// fills the blob
+bool WriteMachine(const std::string& path, const std::string& params, const std::string& sub,
+                  const std::string& mode, uint32_t modeValue, bool withName, uint8_t blobByte) {
+    if (!test::WriteEmptyHive(path)) {
+        return false;
+    }
+    auto hive = HiveRegistryManager::Open(path, {});
+    if (!hive || !hive->CreateKey(params + "\\" + sub) ||
+        !hive->SetValue(params, {mode, ValueType::REG_DWORD, modeValue}) ||
+        !hive->SetValue(params, {"Blob", ValueType::REG_BINARY, std::vector<uint8_t>(kBlobSize, blobByte)}) ||
+        !hive->SetValue(params + "\\" + sub, {"X", ValueType::REG_SZ, std::string("x")})) {
+        return false;
+    }
+    if (withName && !hive->SetValue(params, {"Name", ValueType::REG_SZ, std::string("a")})) {
+        return false;
+    }
+    return hive->Save();
+}
+
+RegistryFactory HiveFactory(const std::string& path) {
+    return [path]() -> std::unique_ptr<RegistryManager> {
+        auto manager = HiveRegistryManager::Open(path, {});
+        if (manager) {
+            manager->SetValueMemoryLimits({64 * 1024, 1024 * 1024});
+        }
+        return manager;
+    };
+}
+
+bool Contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+// Identical machines (up to name case) share a variant; outliers are
+// listed with their differences, and machines without the subtree or
+// whose source fails to open are reported separately
+void TestCompareFleet() {
+    test::TempHive host1("fleet_host1");
+    test::TempHive host2("fleet_host2");
+    test::TempHive host3("fleet_host3");
+    test::TempHive host4("fleet_host4");
+    test::TempHive host6("fleet_host6");
+    CHECK(WriteMachine(host1.Path(), "Svc\\Params", "Sub", "Mode", 1, true, 0x11));
+    CHECK(WriteMachine(host2.Path(), "svc\\PARAMS", "sub", "mode", 1, true, 0x11));
+    CHECK(WriteMachine(host3.Path(), "Svc\\Params", "Sub", "Mode", 2, false, 0x11));
+    CHECK(test::WriteEmptyHive(host4.Path()));
+    CHECK(WriteMachine(host6.Path(), "Svc\\Params", "Sub", "Mode", 1, true, 0x22));
+    {
+        auto hive = HiveRegistryManager::Open(host3.Path(), {});
+        CHECK(hive && hive->CreateKey("Svc\\Params\\Extra") && hive->Save());
+    }
+
+    std::vector<FleetSource> sources = {
+        {"HOST1", HiveFactory(host1.Path())},
+        {"HOST2", HiveFactory(host2.Path())},
+        {"HOST3", HiveFactory(host3.Path())},
+        {"HOST4", HiveFactory(host4.Path())},
+        {"HOST5", []() -> std::unique_ptr<RegistryManager> { return nullptr; }},
+        {"HOST6", HiveFactory(host6.Path())},
+    };
+    FleetReport report = CompareFleet(sources, {"Svc\\Params"}, 2);
+
+    CHECK(report.unavailable == std::vector<std::string>({"HOST5"}));
+    CHECK(report.largeValuesHashed);
+    CHECK(report.subtrees.size() == 1);
+    if (report.subtrees.size() != 1) {
+        return;
+    }
+    const SubtreeComparison& subtree = report.subtrees[0];
+    CHECK(subtree.missing == std::vector<std::string>({"HOST4"}));
+    CHECK(subtree.variants.size() == 3);
+    if (subtree.variants.size() != 3) {
+        return;
+    }
+    CHECK(subtree.variants[0].machines == std::vector<std::string>({"HOST1", "HOST2"}));
+    CHECK(subtree.variants[1].machines == std::vector<std::string>({"HOST3"}));
+    CHECK(subtree.variants[2].machines == std::vector<std::string>({"HOST6"}));
+
+    // Snapshots list keys depth-first with sorted siblings
+    const SubtreeSnapshot& baseline = *subtree.variants[0].snapshot;
+    CHECK(baseline.size() == 2);
+    CHECK(baseline.size() == 2 && baseline[0].path.empty() && baseline[0].values.size() == 3);
+
+    std::string text = FormatFleetReport(report);
+    CHECK(Contains(text, "Svc\\Params: 3 variants\n"));
+    CHECK(Contains(text, "  Variant 1 (2 machines): HOST1, HOST2\n"));
+    CHECK(Contains(text, "  Variant 2 (1 machine, outlier): HOST3\n"
+                         "    ~ Mode: REG_DWORD 0x00000001 (1) -> REG_DWORD 0x00000002 (2)\n"
+                         "    - Name\n"
+                         "    + key Extra\n"));
+    CHECK(Contains(text, "  Variant 3 (1 machine, outlier): HOST6\n"
+                         "    ~ Blob: REG_BINARY (102400 bytes, not loaded) -> "
+                         "REG_BINARY (102400 bytes, not loaded)\n"));
+    CHECK(Contains(text, "  Missing (1): HOST4\n"));
+    CHECK(Contains(text, "Unavailable (1): HOST5\n"));
+    CHECK(Contains(text, "compared by size and a 64-bit content hash"));
+}
+
+} // namespace
+
+int main() {
+    TestCompareFleet();
+    return test::TestResult();
+}
@@ -0,0 +1,302 @@
+#include "hive_test_support.h"
+#include "test_support.h"
+#include "hive_image.h"
+#include "hive_log.h"
+#include "hive_registry_manager.h"
+#include <algorithm>
+#include <iterator>
+
+using namespace registry;
+
+namespace {
+
+// A freed cell merges with free cells on both sides, whatever order the
+// neighbours were freed in
+void TestFreeCellMerging() {
+    test::TempHive hive("free_cells");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto image = HiveImage::Open(hive.Path());
+    CHECK(image != nullptr);
+    if (!image) {
+        return;
+    }
+
+    uint32_t a = image->AllocateCell(100);
+    uint32_t b = image->AllocateCell(100);
+    uint32_t c = image->AllocateCell(100);
+    uint32_t guard = image->AllocateCell(100);
+    CHECK(a != hive::kNoCell && b == a + 104 && c == b + 104 && guard == c + 104);
+
+    image->FreeCell(a);
+    image->FreeCell(c);
+    image->FreeCell(b);
+    CHECK(image->ReadU32(a) == 3 * 104);
+
+    // The merged cell is the best fit for all three
+    CHECK(image->AllocateCell(3 * 104 - 4) == a);
+    CHECK(image->CellCapacity(a) == 3 * 104 - 4);
+
+    // Freeing next to the end of the bin merges with the trailing free space
+    uint32_t tailSize = image->ReadU32(guard + 104);
+    image->FreeCell(guard);
+    CHECK(image->ReadU32(guard) == 104 + tailSize);
+}
+
+std::vector<uint8_t> ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+// Make `hive` a dirty primary whose last complete write was `secondary`,
+// with a new-format log holding the pages in which `updated` differs from
+// it as one entry per sequence number in `sequences`
+void WriteDirtyHive(const std::string& hive, const std::vector<uint8_t>& updated, uint32_t secondary,
+                    const std::vector<uint32_t>& sequences) {
+    using namespace hive;
+
+    std::vector<uint8_t> primary = ReadFile(hive);
+    uint32_t binsSize = LoadU32(updated.data() + kBaseBinsSize);
+    std::vector<uint32_t> pages;
+    for (uint32_t offset = 0; offset < binsSize; offset += kPageSize) {
+        if (!std::equal(updated.begin() + kBaseBlockSize + offset, updated.begin() + kBaseBlockSize + offset + kPageSize,
+                        primary.begin() + kBaseBlockSize + offset)) {
+            pages.push_back(offset);
+        }
+    }
+
+    std::vector<uint8_t> log(updated.begin(), updated.begin() + kLogSectorSize);
+    StoreU32(log.data() + kBasePrimarySequence, sequences.back());
+    StoreU32(log.data() + kBaseSecondarySequence, sequences.back());
+    StoreU32(log.data() + kBaseFileType, kFileTypeLogNew);
+    StoreU32(log.data() + kBaseChecksum, BaseBlockChecksum(log.data()));
+    for (uint32_t sequence : sequences) {
+        std::vector<uint8_t> entry(kLogEntryPages);
+        for (uint32_t offset : pages) {
+            uint8_t reference[8];
+            StoreU32(reference, offset);
+            StoreU32(reference + 4, kPageSize);
+            entry.insert(entry.end(), reference, reference + 8);
+        }
+        for (uint32_t offset : pages) {
+            auto page = updated.begin() + kBaseBlockSize + offset;
+            entry.insert(entry.end(), page, page + kPageSize);
+        }
+        entry.resize((entry.size() + kLogSectorSize - 1) / kLogSectorSize * kLogSectorSize);
+
+        StoreU32(entry.data(), kLogEntrySignature);
+        StoreU32(entry.data() + kLogEntrySize, static_cast<uint32_t>(entry.size()));
+        StoreU32(entry.data() + kLogEntrySequence, sequence);
+        StoreU32(entry.data() + kLogEntryBinsSize, binsSize);
+        StoreU32(entry.data() + kLogEntryPageCount, static_cast<uint32_t>(pages.size()));
+        uint64_t dataHash = Marvin32(entry.data() + kLogEntryPages, entry.size() - kLogEntryPages, kLogEntryHashSeed);
+        StoreU32(entry.data() + kLogEntryDataHash, static_cast<uint32_t>(dataHash));
+        StoreU32(entry.data() + kLogEntryDataHash + 4, static_cast<uint32_t>(dataHash >> 32));
+        uint64_t headerHash = Marvin32(entry.data(), kLogEntryDataHash + 8, kLogEntryHashSeed);
+        StoreU32(entry.data() + kLogEntryHeaderHash, static_cast<uint32_t>(headerHash));
+        StoreU32(entry.data() + kLogEntryHeaderHash + 4, static_cast<uint32_t>(headerHash >> 32));
+        log.insert(log.end(), entry.begin(), entry.end());
+    }
+    WriteFile(hive + ".LOG1", log);
+
+    StoreU32(primary.data() + kBasePrimarySequence, secondary + 1);
+    StoreU32(primary.data() + kBaseSecondarySequence, secondary);
+    StoreU32(primary.data() + kBaseChecksum, BaseBlockChecksum(primary.data()));
+    WriteFile(hive, primary);
+}
+
+// Log entries are replayed only if they continue from the primary file's
+// secondary sequence number without a gap
+void TestRecoveryContinuity() {
+    test::TempHive updated("recovery_updated");
+    test::TempHive hive("recovery");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    {
+        auto manager = HiveRegistryManager::Open(hive.Path(), {});
+        CHECK(manager && manager->CreateKey("Recovered"));
+        CHECK(manager && manager->SaveAs(updated.Path()));
+    }
+    std::vector<uint8_t> clean = ReadFile(hive.Path());
+    std::vector<uint8_t> changes = ReadFile(updated.Path());
+
+    struct Case {
+        uint32_t secondary;
+        std::vector<uint32_t> sequences;
+        bool replayed;
+    };
+    const Case cases[] = {
+        {1, {1}, true},
+        {5, {3, 4, 5, 6}, true},  // entries below the secondary were already written
+        {1, {2}, false},          // the entry for sequence 1 is missing
+        {1, {2, 3}, false},
+    };
+    for (const auto& c : cases) {
+        WriteFile(hive.Path(), clean);
+        WriteDirtyHive(hive.Path(), changes, c.secondary, c.sequences);
+        auto manager = HiveRegistryManager::Open(hive.Path(), {hive.Path() + ".LOG1"});
+        CHECK(manager != nullptr);
+        if (manager) {
+            CHECK(manager->ReplayedLogs() == c.replayed);
+            CHECK(manager->IsReadOnly() == !c.replayed);
+            CHECK(manager->OpenKey("Recovered").has_value() == c.replayed);
+        }
+    }
+}
+
+// A dirty hive without usable logs can be browsed, but writing it would
+// mark it consistent and lose the log data for good
+void TestDirtyHiveWithoutLogs() {
+    test::TempHive updated("dirty_updated");
+    test::TempHive hive("dirty");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    {
+        auto manager = HiveRegistryManager::Open(hive.Path(), {});
+        CHECK(manager && manager->CreateKey("Pending"));
+        CHECK(manager && manager->SaveAs(updated.Path()));
+    }
+    WriteDirtyHive(hive.Path(), ReadFile(updated.Path()), 1, {1});
+    std::remove((hive.Path() + ".LOG1").c_str());
+    std::vector<uint8_t> dirty = ReadFile(hive.Path());
+
+    auto manager = HiveRegistryManager::Open(hive.Path());
+    CHECK(manager != nullptr);
+    if (!manager) {
+        return;
+    }
+    CHECK(manager->IsReadOnly());
+    CHECK(!manager->ReplayedLogs());
+    CHECK(manager->OpenKey("").has_value());
+    CHECK(!manager->CreateKey("New"));
+    CHECK(!manager->SetValue("", {"v", ValueType::REG_DWORD, uint32_t{1}}));
+    CHECK(!manager->HasUnsavedChanges());
+    CHECK(manager->Save());
+    CHECK(!manager->SaveAs(updated.Path()));
+    CHECK(ReadFile(hive.Path()) == dirty);
+}
+
+// SaveAs never truncates the file it is reading from, whatever the name
+void TestSaveAsOwnFile() {
+    test::TempHive hive("save_as_self");
+    test::TempHive copy("save_as_copy");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    const std::string link = hive.Path() + ".link";
+    std::remove(link.c_str());
+    CHECK(symlink(hive.Path().c_str(), link.c_str()) == 0);
+
+    auto image = HiveImage::Open(hive.Path());
+    CHECK(image != nullptr);
+    if (image) {
+        CHECK(!image->SaveAs(hive.Path()));
+        CHECK(!image->SaveAs(link));
+        CHECK(image->SaveAs(copy.Path()));
+        CHECK(ReadFile(hive.Path()).size() == ReadFile(copy.Path()).size());
+    }
+    std::remove(link.c_str());
+}
+
+// Make `hive` a dirty primary whose interrupted write was `secondary` + 1,
+// with an old-format log (a DIRT vector of 512-byte sectors) taken at
+// `sequence` and holding the sectors in which `updated` differs from it
+void WriteDirtyVectorHive(const std::string& hive, const std::vector<uint8_t>& updated, uint32_t secondary,
+                          uint32_t sequence) {
+    using namespace hive;
+
+    std::vector<uint8_t> primary = ReadFile(hive);
+    uint32_t binsSize = LoadU32(updated.data() + kBaseBinsSize);
+
+    std::vector<uint8_t> log(updated.begin(), updated.begin() + kLogSectorSize);
+    StoreU32(log.data() + kBasePrimarySequence, sequence);
+    StoreU32(log.data() + kBaseSecondarySequence, sequence);
+    StoreU32(log.data() + kBaseFileType, kFileTypeLog);
+    StoreU32(log.data() + kBaseChecksum, BaseBlockChecksum(log.data()));
+
+    std::vector<uint8_t> vector(4 + binsSize / kLogSectorSize / 8, 0);
+    StoreU32(vector.data(), kDirtyVectorSignature);
+    std::vector<uint8_t> sectors;
+    for (uint32_t offset = 0; offset < binsSize; offset += kLogSectorSize) {
+        auto sector = updated.begin() + kBaseBlockSize + offset;
+        if (!std::equal(sector, sector + kLogSectorSize, primary.begin() + kBaseBlockSize + offset)) {
+            uint32_t index = offset / kLogSectorSize;
+            vector[4 + index / 8] |= static_cast<uint8_t>(1u << (index % 8));
+            sectors.insert(sectors.end(), sector, sector + kLogSectorSize);
+        }
+    }
+    log.insert(log.end(), vector.begin(), vector.end());
+    log.resize((log.size() + kLogSectorSize - 1) / kLogSectorSize * kLogSectorSize);
+    log.insert(log.end(), sectors.begin(), sectors.end());
+    WriteFile(hive + ".LOG", log);
+
+    StoreU32(primary.data() + kBasePrimarySequence, secondary + 1);
+    StoreU32(primary.data() + kBaseSecondarySequence, secondary);
+    StoreU32(primary.data() + kBaseChecksum, BaseBlockChecksum(primary.data()));
+    WriteFile(hive, primary);
+}
+
+// An old-format log is a snapshot of the write that was interrupted, so it
+// is replayed only if it was taken at the primary sequence number
+void TestDirtyVectorRecovery() {
+    test::TempHive updated("dirt_updated");
+    test::TempHive hive("dirt");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    {
+        auto manager = HiveRegistryManager::Open(hive.Path(), {});
+        CHECK(manager && manager->CreateKey("Recovered"));
+        CHECK(manager && manager->SaveAs(updated.Path()));
+    }
+    std::vector<uint8_t> clean = ReadFile(hive.Path());
+    std::vector<uint8_t> changes = ReadFile(updated.Path());
+
+    struct Case {
+        uint32_t secondary;
+        uint32_t sequence;
+        bool replayed;
+    };
+    const Case cases[] = {
+        {1, 2, true},
+        {7, 8, true},
+        {1, 1, false},  // taken before the last complete write
+        {1, 3, false},  // the write for sequence 2 is missing
+    };
+    for (const auto& c : cases) {
+        WriteFile(hive.Path(), clean);
+        WriteDirtyVectorHive(hive.Path(), changes, c.secondary, c.sequence);
+
+        auto log = HiveLog::Read(hive.Path() + ".LOG");
+        CHECK(log != nullptr);
+        CHECK(log && !log->IsNewFormat() && log->Entries().size() == 1);
+
+        auto manager = HiveRegistryManager::Open(hive.Path(), {hive.Path() + ".LOG"});
+        CHECK(manager != nullptr);
+        if (manager) {
+            CHECK(manager->ReplayedLogs() == c.replayed);
+            CHECK(manager->IsReadOnly() == !c.replayed);
+            CHECK(manager->OpenKey("Recovered").has_value() == c.replayed);
+        }
+    }
+
+    // Recovered pages are written back, leaving a clean hive
+    WriteFile(hive.Path(), clean);
+    WriteDirtyVectorHive(hive.Path(), changes, 1, 2);
+    {
+        auto manager = HiveRegistryManager::Open(hive.Path());
+        CHECK(manager && manager->Save());
+    }
+    std::remove((hive.Path() + ".LOG").c_str());
+    auto reopened = HiveRegistryManager::Open(hive.Path(), {});
+    CHECK(reopened && !reopened->IsReadOnly() && reopened->OpenKey("Recovered").has_value());
+}
+
+} // namespace
+
+int main() {
+    TestFreeCellMerging();
+    TestRecoveryContinuity();
+    TestDirtyVectorRecovery();
+    TestDirtyHiveWithoutLogs();
+    TestSaveAsOwnFile();
+    return test::TestResult();
+}
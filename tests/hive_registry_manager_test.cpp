@@ -0,0 +1,297 @@
+#include "hive_test_support.h"
+#include "test_support.h"
+#include "hive_registry_manager.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+using namespace registry;
+
+namespace {
+
+std::unique_ptr<HiveRegistryManager> OpenHive(const test::TempHive& hive) {
+    auto manager = HiveRegistryManager::Open(hive.Path(), {});
+    CHECK(manager != nullptr);
+    return manager;
+}
+
+void TestRoundTrip() {
+    test::TempHive hive("round_trip");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    CHECK(manager->CreateKey("Software\\Vendor"));
+    CHECK(manager->SetValue("Software\\Vendor", {"Name", ValueType::REG_SZ, std::string("hôst")}));
+    CHECK(manager->SetValue("Software\\Vendor", {"Count", ValueType::REG_DWORD, uint32_t{7}}));
+    CHECK(manager->HasUnsavedChanges());
+    CHECK(manager->Save());
+    CHECK(!manager->HasUnsavedChanges());
+
+    manager = OpenHive(hive);
+    auto values = manager->GetValues("SOFTWARE\\vendor");
+    CHECK(values.size() == 2);
+    CHECK(manager->OpenKey("software\\VENDOR").has_value());
+    CHECK(!manager->OpenKey("Software\\Other").has_value());
+}
+
+// Names fold with the full UTF-16 upcase table, for lookup, ordering and
+// the lh hashes alike
+void TestNonAsciiNames() {
+    test::TempHive hive("non_ascii");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    const std::vector<std::string> names = {"привет", "алфавит", "ÿes", "Яблоко", "Zeta"};
+    for (const auto& name : names) {
+        CHECK(manager->CreateKey("K\\" + name));
+    }
+    CHECK(manager->SetValue("K\\привет", {"Имя", ValueType::REG_SZ, std::string("1")}));
+    CHECK(manager->Save());
+
+    manager = OpenHive(hive);
+    const std::vector<std::string> sorted = {"Zeta", "ÿes", "алфавит", "привет", "Яблоко"};
+    CHECK(manager->GetSubkeys("K") == sorted);
+
+    auto key = manager->OpenKey("K\\ПРИВЕТ");
+    CHECK(key.has_value());
+    CHECK(key && key->name == "привет");
+    CHECK(manager->OpenKey("K\\ŸES").has_value());
+    CHECK(manager->OpenKey("k\\яБЛОКО").has_value());
+    CHECK(!manager->OpenKey("K\\привет2").has_value());
+
+    // Differently cased names refer to the existing key and value
+    CHECK(manager->CreateKey("K\\АЛФАВИТ"));
+    CHECK(manager->GetSubkeys("K").size() == names.size());
+    CHECK(manager->SetValue("K\\ПРИВЕТ", {"иМЯ", ValueType::REG_SZ, std::string("2")}));
+    auto values = manager->GetValues("K\\привет");
+    CHECK(values.size() == 1);
+    CHECK(!values.empty() && values[0].data == ValueData(std::string("2")));
+
+    CHECK(manager->DeleteKey("K\\zETA"));
+    CHECK(manager->DeleteKey("K\\ЯБЛОКО"));
+    CHECK(manager->Save());
+    manager = OpenHive(hive);
+    CHECK(manager->GetSubkeys("K") == std::vector<std::string>({"ÿes", "алфавит", "привет"}));
+}
+
+// Values of unmapped types survive a save with their type code and data
+void TestRawTypes() {
+    test::TempHive hive("raw_types");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    Value resource{"Resource", ValueType::UNKNOWN, std::vector<uint8_t>{1, 2, 3, 4, 5}};
+    resource.rawType = 9;
+    CHECK(manager->SetValue("", resource));
+    CHECK(manager->SetValue("", {"None", ValueType::REG_NONE, std::vector<uint8_t>{7, 8}}));
+    CHECK(manager->Save());
+
+    manager = OpenHive(hive);
+    auto values = manager->GetValues("");
+    CHECK(values.size() == 2);
+    for (const auto& value : values) {
+        if (value.name == "Resource") {
+            CHECK(value.type == ValueType::UNKNOWN && value.rawType == 9);
+            CHECK(value.data == resource.data);
+        } else {
+            CHECK(value.type == ValueType::REG_NONE && value.rawType == 0);
+            CHECK(value.data == ValueData(std::vector<uint8_t>{7, 8}));
+        }
+    }
+}
+
+std::string KeyName(int i) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "key%04d", i);
+    return name;
+}
+
+// Enough subkeys for an index root over several leaves, inserted and
+// deleted out of order
+void TestManySubkeys() {
+    test::TempHive hive("many_subkeys");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    const int kCount = 3000;
+    std::vector<int> order(kCount);
+    for (int i = 0; i < kCount; ++i) {
+        order[i] = i;
+    }
+    std::mt19937 random(42);
+    std::shuffle(order.begin(), order.end(), random);
+    for (int i : order) {
+        CHECK(manager->CreateKey("K\\" + KeyName(i)));
+    }
+
+    std::vector<std::string> expected;
+    for (int i = 0; i < kCount; ++i) {
+        expected.push_back(KeyName(i));
+    }
+    CHECK(manager->GetSubkeys("K") == expected);
+    CHECK(manager->Save());
+
+    manager = OpenHive(hive);
+    CHECK(manager->GetSubkeys("K") == expected);
+    for (int i = 0; i < kCount; i += 97) {
+        CHECK(manager->OpenKey("K\\" + KeyName(i)).has_value());
+    }
+
+    std::shuffle(order.begin(), order.end(), random);
+    for (int i : order) {
+        if (i % 2 == 1) {
+            CHECK(manager->DeleteKey("K\\" + KeyName(i)));
+        }
+    }
+    expected.clear();
+    for (int i = 0; i < kCount; i += 2) {
+        expected.push_back(KeyName(i));
+    }
+    CHECK(manager->GetSubkeys("K") == expected);
+    CHECK(!manager->OpenKey("K\\" + KeyName(1)).has_value());
+    CHECK(manager->OpenKey("K\\" + KeyName(2)).has_value());
+
+    for (int i = 0; i < kCount; i += 2) {
+        CHECK(manager->DeleteKey("K\\" + KeyName(i)));
+    }
+    CHECK(manager->GetSubkeys("K").empty());
+    CHECK(manager->CreateKey("K\\again"));
+    CHECK(manager->GetSubkeys("K") == std::vector<std::string>({"again"}));
+}
+
+std::vector<uint8_t> Pattern(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    }
+    return bytes;
+}
+
+// Values above the threshold are read in chunks and cannot be written back
+void TestLargeValues() {
+    test::TempHive hive("large_values");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    const std::vector<uint8_t> blob = Pattern(200 * 1024);
+    CHECK(manager->CreateKey("K"));
+    CHECK(manager->SetValue("K", {"Blob", ValueType::REG_BINARY, blob}));
+    manager->SetValueMemoryLimits({64 * 1024, 1024 * 1024});
+
+    auto values = manager->GetValues("K");
+    CHECK(values.size() == 1);
+    if (values.size() != 1) {
+        return;
+    }
+    CHECK(values[0].large != nullptr);
+    CHECK(values[0].large && values[0].large->Size() == blob.size());
+
+    std::vector<uint8_t> read(blob.size());
+    CHECK(values[0].large && values[0].large->ReadChunk(0, read.data(), read.size()) == blob.size());
+    CHECK(read == blob);
+
+    // A new handle to the unchanged value reads the cached chunks instead
+    // of caching a second copy
+    size_t usage = manager->MemoryUsage();
+    auto again = manager->GetValues("K");
+    CHECK(again.size() == 1 && again[0].large != nullptr);
+    if (again.size() == 1 && again[0].large) {
+        std::fill(read.begin(), read.end(), 0);
+        CHECK(again[0].large->ReadChunk(0, read.data(), read.size()) == blob.size());
+        CHECK(read == blob);
+        CHECK(manager->MemoryUsage() == usage);
+    }
+
+    // Writing the handle back would store no data at all
+    CHECK(!manager->SetValue("K", values[0]));
+    manager->SetValueMemoryLimits({});
+    values = manager->GetValues("K");
+    CHECK(values.size() == 1 && values[0].data == ValueData(blob));
+}
+
+// Values under the threshold count against the budget too: once a key's
+// eagerly loaded data would exceed it, the rest come back as handles
+void TestEagerValueBudget() {
+    test::TempHive hive("eager_budget");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    const size_t kCount = 100;
+    const size_t kValueSize = 1000;
+    CHECK(manager->CreateKey("K"));
+    for (size_t i = 0; i < kCount; ++i) {
+        std::vector<uint8_t> bytes(kValueSize, static_cast<uint8_t>(i));
+        CHECK(manager->SetValue("K", {"V" + std::to_string(i), ValueType::REG_BINARY, bytes}));
+    }
+    CHECK(manager->SetValue("K", {"Small", ValueType::REG_DWORD, uint32_t{5}}));
+    manager->SetValueMemoryLimits({64 * 1024, 16 * 1024});
+
+    auto values = manager->GetValues("K");
+    CHECK(values.size() == kCount + 1);
+    size_t eager = 0;
+    std::vector<uint8_t> read(kValueSize);
+    for (const auto& value : values) {
+        if (value.name == "Small") {
+            // Data stored in the value cell itself is always loaded
+            CHECK(value.large == nullptr && value.data == ValueData(uint32_t{5}));
+            continue;
+        }
+        uint8_t expected = static_cast<uint8_t>(std::stoul(value.name.substr(1)));
+        if (!value.large) {
+            eager += kValueSize;
+            CHECK(value.data == ValueData(std::vector<uint8_t>(kValueSize, expected)));
+            continue;
+        }
+        CHECK(value.large->Size() == kValueSize);
+        CHECK(value.large->ReadChunk(0, read.data(), read.size()) == kValueSize);
+        CHECK(read == std::vector<uint8_t>(kValueSize, expected));
+    }
+    CHECK(eager == 16 * kValueSize);
+
+    manager->SetValueMemoryLimits({});
+    values = manager->GetValues("K");
+    CHECK(std::none_of(values.begin(), values.end(), [](const Value& value) { return value.large != nullptr; }));
+}
+
+// A deleted key's cell may be reused, so KeyId lookups must not resolve to
+// whatever now occupies it, and a key re-created under the same ID must be
+// found again
+void TestKeyIdsAfterDelete() {
+    test::TempHive hive("key_ids");
+    CHECK(test::WriteEmptyHive(hive.Path()));
+    auto manager = OpenHive(hive);
+
+    KeyId id = manager->Paths().Intern("Software\\Old");
+    CHECK(manager->CreateKey(id));
+    CHECK(manager->SetValue(id, {"A", ValueType::REG_DWORD, uint32_t{1}}));
+    CHECK(manager->GetValues(id).size() == 1);
+
+    CHECK(manager->DeleteKey(id));
+    CHECK(!manager->OpenKey(id).has_value());
+    CHECK(manager->CreateKey("Software\\New"));
+    CHECK(manager->SetValue("Software\\New", {"B", ValueType::REG_DWORD, uint32_t{2}}));
+    CHECK(!manager->OpenKey(id).has_value());
+    CHECK(manager->GetValues(id).empty());
+    CHECK(!manager->SetValue(id, {"C", ValueType::REG_DWORD, uint32_t{3}}));
+
+    CHECK(manager->CreateKey(id));
+    CHECK(manager->GetValues(id).empty());
+    CHECK(manager->SetValue(id, {"D", ValueType::REG_DWORD, uint32_t{4}}));
+    auto values = manager->GetValues(id);
+    CHECK(values.size() == 1 && values[0].name == "D");
+    CHECK(manager->GetValues("Software\\New").size() == 1);
+    CHECK(manager->GetSubkeyIds(manager->Paths().Parent(id)).size() == 2);
+}
+
+} // namespace
+
+int main() {
+    TestRoundTrip();
+    TestNonAsciiNames();
+    TestRawTypes();
+    TestManySubkeys();
+    TestLargeValues();
+    TestEagerValueBudget();
+    TestKeyIdsAfterDelete();
+    return test::TestResult();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "hive_util.h"
+
+// Builds hive files for the tests: a base block and one hive bin holding
+// the root key, with the rest of the bin free
+namespace test {
+
+inline void PutU16(std::vector<uint8_t>& buffer, size_t offset, uint16_t value) {
+    registry::hive::StoreU16(buffer.data() + offset, value);
+}
+
+inline void PutU32(std::vector<uint8_t>& buffer, size_t offset, uint32_t value) {
+    registry::hive::StoreU32(buffer.data() + offset, value);
+}
+
+inline bool WriteEmptyHive(const std::string& path, uint32_t minorVersion = 5) {
+    using namespace registry::hive;
+
+    const uint32_t rootCell = kBinHeaderSize;
+    const std::string rootName = "ROOT";
+    const uint32_t rootSize = (4 + kKeyName + static_cast<uint32_t>(rootName.size()) + 7) & ~7u;
+
+    std::vector<uint8_t> file(kBaseBlockSize + kPageSize, 0);
+    PutU32(file, 0, kBaseSignature);
+    PutU32(file, kBasePrimarySequence, 1);
+    PutU32(file, kBaseSecondarySequence, 1);
+    PutU32(file, kBaseMajorVersion, 1);
+    PutU32(file, kBaseMinorVersion, minorVersion);
+    PutU32(file, kBaseFileType, kFileTypePrimary);
+    PutU32(file, 32, 1);  // format: direct memory load
+    PutU32(file, kBaseRootCell, rootCell);
+    PutU32(file, kBaseBinsSize, kPageSize);
+    PutU32(file, kBaseChecksum, BaseBlockChecksum(file.data()));
+
+    const size_t bin = kBaseBlockSize;
+    PutU32(file, bin, kBinSignature);
+    PutU32(file, bin + kBinOffset, 0);
+    PutU32(file, bin + kBinSize, kPageSize);
+
+    const size_t nk = bin + rootCell + 4;
+    PutU32(file, bin + rootCell, static_cast<uint32_t>(-static_cast<int32_t>(rootSize)));
+    PutU16(file, nk, kKeyNodeSignature);
+    PutU16(file, nk + kKeyFlags, kKeyFlagRoot | kKeyFlagCompressedName);
+    PutU32(file, nk + kKeyParent, kNoCell);
+    PutU32(file, nk + kKeySubkeyList, kNoCell);
+    PutU32(file, nk + kKeySubkeyList + 4, kNoCell);
+    PutU32(file, nk + kKeyValueList, kNoCell);
+    PutU32(file, nk + kKeySecurity, kNoCell);
+    PutU32(file, nk + kKeyClassName, kNoCell);
+    PutU16(file, nk + kKeyNameLength, static_cast<uint16_t>(rootName.size()));
+    for (size_t i = 0; i < rootName.size(); ++i) {
+        file[nk + kKeyName + i] = static_cast<uint8_t>(rootName[i]);
+    }
+
+    PutU32(file, bin + rootCell + rootSize, kPageSize - rootCell - rootSize);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    return static_cast<bool>(out);
+}
+
+// A hive file path that is removed, with its logs, when the test ends
+class TempHive {
+public:
+    explicit TempHive(const std::string& name)
+        : path_("/tmp/regedit_" + name + "_" + std::to_string(getpid()) + ".dat") {}
+    ~TempHive() {
+        for (const char* suffix : {"", ".LOG", ".LOG1", ".LOG2"}) {
+            std::remove((path_ + suffix).c_str());
+        }
+    }
+    const std::string& Path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+} // namespace test
@@ -0,0 +1,148 @@
+#include "hive_test_support.h"
+#include "test_support.h"
+#include "hive_registry_manager.h"
+#include "mounted_registry_manager.h"
+
+using namespace registry;
+
+namespace {
+
+RegistryFactory HiveFactory(const std::string& path) {
+    return [path]() -> std::unique_ptr<RegistryManager> {
+        return HiveRegistryManager::Open(path, {});
+    };
+}
+
+bool HiveHasKey(const std::string& path, const std::string& key) {
+    auto hive = HiveRegistryManager::Open(path, {});
+    return hive && hive->OpenKey(key).has_value();
+}
+
+void TestSave() {
+    test::TempHive first("mounted_first");
+    test::TempHive second("mounted_second");
+    CHECK(test::WriteEmptyHive(first.Path()));
+    CHECK(test::WriteEmptyHive(second.Path()));
+
+    MountedRegistryManager mounted;
+    CHECK(mounted.Mount("HOST1\\SOFTWARE", HiveFactory(first.Path())));
+    CHECK(mounted.Mount("HOST2\\SOFTWARE", HiveFactory(second.Path())));
+    CHECK(!mounted.HasUnsavedChanges());
+
+    CHECK(mounted.CreateKey("HOST1\\SOFTWARE\\One"));
+    CHECK(mounted.CreateKey("host2\\software\\Two"));
+    CHECK(mounted.HasUnsavedChanges());
+    CHECK(mounted.GetUnsavedMounts() == std::vector<std::string>({"HOST1\\SOFTWARE", "HOST2\\SOFTWARE"}));
+
+    // Unsaved sources are neither unmounted nor closed for the budget
+    CHECK(!mounted.Unmount("HOST1\\SOFTWARE"));
+    mounted.SetMemoryBudget(1);
+    CHECK(mounted.GetUnsavedMounts().size() == 2);
+
+    CHECK(mounted.Save("host1\\SOFTWARE"));
+    CHECK(HiveHasKey(first.Path(), "One"));
+    CHECK(!HiveHasKey(second.Path(), "Two"));
+    CHECK(mounted.GetUnsavedMounts() == std::vector<std::string>({"HOST2\\SOFTWARE"}));
+    CHECK(!mounted.Save("HOST3"));
+
+    CHECK(mounted.Save());
+    CHECK(!mounted.HasUnsavedChanges());
+    CHECK(HiveHasKey(second.Path(), "Two"));
+
+    // Saved sources can be closed again; they reopen on access
+    mounted.SetMemoryBudget(1);
+    CHECK(mounted.OpenKey("HOST2\\SOFTWARE\\Two").has_value());
+    CHECK(mounted.Unmount("HOST1\\SOFTWARE"));
+}
+
+// Options set on the mount table reach sources opened before and after
+void TestParallelEnumerationForwarded() {
+    test::TempHive first("parallel_first");
+    test::TempHive second("parallel_second");
+    CHECK(test::WriteEmptyHive(first.Path()));
+    CHECK(test::WriteEmptyHive(second.Path()));
+
+    std::vector<RegistryManager*> opened;
+    auto tracking = [&opened](const std::string& path) -> RegistryFactory {
+        return [&opened, path]() -> std::unique_ptr<RegistryManager> {
+            auto manager = HiveRegistryManager::Open(path, {});
+            opened.push_back(manager.get());
+            return manager;
+        };
+    };
+
+    MountedRegistryManager mounted;
+    CHECK(mounted.Mount("HOST1", tracking(first.Path())));
+    CHECK(mounted.Mount("HOST2", tracking(second.Path())));
+    CHECK(mounted.OpenKey("HOST1").has_value());
+    CHECK(opened.size() == 1);
+
+    mounted.SetParallelEnumeration({512, 4});
+    CHECK(opened[0]->GetParallelEnumeration().threshold == 512);
+    CHECK(opened[0]->GetParallelEnumeration().maxThreads == 4);
+
+    CHECK(mounted.OpenKey("HOST2").has_value());
+    CHECK(opened.size() == 2);
+    CHECK(opened[1]->GetParallelEnumeration().threshold == 512);
+    CHECK(opened[1]->GetParallelEnumeration().maxThreads == 4);
+}
+
+bool WriteBlob(const std::string& path, size_t size) {
+    auto hive = HiveRegistryManager::Open(path, {});
+    return hive && hive->SetValue("", {"Blob", ValueType::REG_BINARY, std::vector<uint8_t>(size, 0x5A)}) &&
+           hive->Save();
+}
+
+// Sources read large values through the mount table's one cache, which is
+// counted once and stays within a single budget
+void TestSharedChunkCache() {
+    const size_t kBlobSize = 200 * 1024;
+    const size_t kCacheBytes = 256 * 1024;
+    test::TempHive first("cache_first");
+    test::TempHive second("cache_second");
+    CHECK(test::WriteEmptyHive(first.Path()));
+    CHECK(test::WriteEmptyHive(second.Path()));
+    CHECK(WriteBlob(first.Path(), kBlobSize));
+    CHECK(WriteBlob(second.Path(), kBlobSize));
+
+    std::vector<RegistryManager*> opened;
+    auto tracking = [&opened](const std::string& path) -> RegistryFactory {
+        return [&opened, path]() -> std::unique_ptr<RegistryManager> {
+            auto manager = HiveRegistryManager::Open(path, {});
+            opened.push_back(manager.get());
+            return manager;
+        };
+    };
+
+    MountedRegistryManager mounted;
+    CHECK(mounted.Mount("HOST1", tracking(first.Path())));
+    CHECK(mounted.Mount("HOST2", tracking(second.Path())));
+    mounted.SetValueMemoryLimits({64 * 1024, kCacheBytes});
+
+    std::vector<uint8_t> read(kBlobSize);
+    for (const char* host : {"HOST1", "HOST2"}) {
+        auto values = mounted.GetValues(host);
+        CHECK(values.size() == 1 && values[0].large != nullptr);
+        if (values.size() == 1 && values[0].large) {
+            CHECK(values[0].large->ReadChunk(0, read.data(), read.size()) == kBlobSize);
+        }
+    }
+    CHECK(opened.size() == 2);
+
+    size_t sources = 0;
+    for (auto* manager : opened) {
+        sources += manager->MemoryUsage();
+    }
+    size_t cached = mounted.MemoryUsage() - sources;
+    CHECK(cached > 0);
+    CHECK(cached <= kCacheBytes);
+}
+
+} // namespace
+
+int main() {
+    TestSave();
+    TestParallelEnumerationForwarded();
+    TestSharedChunkCache();
+    return test::TestResult();
+}
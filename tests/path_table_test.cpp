@@ -0,0 +1,83 @@
+#include "test_support.h"
+#include "path_table.h"
+
+using namespace registry;
+
+namespace {
+
+// Names match case-insensitively with the registry's folding, and the first
+// spelling seen is kept
+void TestChildLookup() {
+    PathTable paths;
+    KeyId software = paths.Child(kRootKeyId, "Software");
+    CHECK(software != kInvalidKeyId && software != kRootKeyId);
+    CHECK(paths.Child(kRootKeyId, "SOFTWARE") == software);
+    CHECK(paths.FindChild(kRootKeyId, "software") == software);
+    CHECK(paths.Name(software) == "Software");
+
+    KeyId cyrillic = paths.Child(software, "Привет");
+    CHECK(paths.Child(software, "пРИВЕТ") == cyrillic);
+    CHECK(paths.FindChild(software, "ПРИВЕТ") == cyrillic);
+    KeyId latin = paths.Child(software, "ÿes");
+    CHECK(paths.FindChild(software, "ŸES") == latin);
+    CHECK(latin != cyrillic);
+    CHECK(paths.Path(cyrillic) == "Software\\Привет");
+
+    // Lookups never intern, and names are scoped to their parent
+    size_t size = paths.Size();
+    CHECK(paths.FindChild(kRootKeyId, "Привет") == kInvalidKeyId);
+    CHECK(paths.FindChild(software, "Other") == kInvalidKeyId);
+    CHECK(paths.Size() == size);
+
+    CHECK(paths.Child(kInvalidKeyId, "X") == kInvalidKeyId);
+    CHECK(paths.Child(static_cast<KeyId>(size), "X") == kInvalidKeyId);
+    CHECK(paths.FindChild(kInvalidKeyId, "Software") == kInvalidKeyId);
+    CHECK(paths.Size() == size);
+}
+
+// Empty path components are skipped
+void TestInternSeparators() {
+    PathTable paths;
+    KeyId id = paths.Intern("Software\\Vendor\\App");
+    CHECK(paths.Path(id) == "Software\\Vendor\\App");
+    CHECK(paths.Intern("\\Software\\Vendor\\App") == id);
+    CHECK(paths.Intern("Software\\Vendor\\App\\") == id);
+    CHECK(paths.Intern("Software\\\\Vendor\\\\\\App") == id);
+    CHECK(paths.Intern("\\\\software\\VENDOR\\app\\\\") == id);
+    CHECK(paths.Size() == 4);
+
+    CHECK(paths.Intern("") == kRootKeyId);
+    CHECK(paths.Intern("\\") == kRootKeyId);
+    CHECK(paths.Intern("\\\\\\") == kRootKeyId);
+    CHECK(paths.Size() == 4);
+}
+
+void TestParentAndPath() {
+    PathTable paths;
+    CHECK(paths.IsValid(kRootKeyId));
+    CHECK(paths.Parent(kRootKeyId) == kInvalidKeyId);
+    CHECK(paths.Path(kRootKeyId).empty());
+    CHECK(paths.Name(kRootKeyId).empty());
+
+    KeyId app = paths.Intern("Software\\App");
+    KeyId software = paths.Parent(app);
+    CHECK(paths.Path(software) == "Software");
+    CHECK(paths.Parent(software) == kRootKeyId);
+    CHECK(paths.Name(app) == "App");
+
+    for (KeyId invalid : {kInvalidKeyId, static_cast<KeyId>(paths.Size())}) {
+        CHECK(!paths.IsValid(invalid));
+        CHECK(paths.Parent(invalid) == kInvalidKeyId);
+        CHECK(paths.Path(invalid).empty());
+        CHECK(paths.Name(invalid).empty());
+    }
+}
+
+} // namespace
+
+int main() {
+    TestChildLookup();
+    TestInternSeparators();
+    TestParentAndPath();
+    return test::TestResult();
+}
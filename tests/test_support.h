@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+
+// Minimal checks for the test executables. A failed check is reported and
+// counted; each test's main() returns TestResult().
+namespace test {
+
+inline int& Failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline int TestResult() {
+    if (Failures() != 0) {
+        std::cerr << Failures() << " check(s) failed" << std::endl;
+    }
+    return Failures() == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition \
+                      << std::endl;                                                   \
+            ++test::Failures();                                                       \
+        }                                                                             \
+    } while (0)
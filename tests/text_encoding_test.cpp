@@ -0,0 +1,142 @@
+#include "test_support.h"
+#include "text_encoding.h"
+#include <string>
+
+using namespace registry;
+
+namespace {
+
+std::u16string ToUtf16(const std::string& utf8) {
+    std::u16string out;
+    Utf8ToUtf16(utf8, out);
+    return out;
+}
+
+std::string ToUtf8(const std::u16string& utf16) {
+    return Utf16ToUtf8(utf16.data(), utf16.size());
+}
+
+// Runs of every length around the 16-byte SIMD and 8-byte SWAR blocks,
+// with a non-ASCII character at each position to hit every fallback
+void TestAsciiRuns() {
+    for (size_t length = 0; length < 70; ++length) {
+        std::string ascii;
+        for (size_t i = 0; i < length; ++i) {
+            ascii += static_cast<char>('a' + i % 26);
+        }
+        std::u16string wide = ToUtf16(ascii);
+        CHECK(wide.size() == length);
+        CHECK(std::u16string(ascii.begin(), ascii.end()) == wide);
+        CHECK(ToUtf8(wide) == ascii);
+
+        for (size_t at = 0; at <= length; at += 5) {
+            std::string mixed = ascii.substr(0, at) + "\xC3\xA9" + ascii.substr(at);
+            std::u16string mixedWide = ToUtf16(mixed);
+            CHECK(mixedWide.size() == length + 1);
+            CHECK(mixedWide[at] == u'é');
+            CHECK(ToUtf8(mixedWide) == mixed);
+        }
+    }
+}
+
+void TestValidMultibyte() {
+    CHECK(ToUtf16("\xD0\xBF\xD1\x80\xD0\xB8") == u"при");
+    CHECK(ToUtf16("\xE2\x82\xAC") == u"€");
+    CHECK(ToUtf16("\xF0\x9F\x98\x80") == u"\xD83D\xDE00");
+    CHECK(ToUtf16("\xF4\x8F\xBF\xBF") == u"\xDBFF\xDFFF");
+    CHECK(ToUtf8(u"\xD83D\xDE00") == "\xF0\x9F\x98\x80");
+    CHECK(ToUtf8(u"€ÿ") == "\xE2\x82\xAC\xC3\xBF");
+}
+
+void TestInvalidUtf8() {
+    // Lone continuation bytes and bytes that never start a sequence
+    CHECK(ToUtf16("\x80") == u"�");
+    CHECK(ToUtf16("a\xBFz") == u"a�z");
+    CHECK(ToUtf16("\xF5\xFF") == u"��");
+
+    // Truncated sequences, at the end and followed by ASCII
+    CHECK(ToUtf16("\xC3") == u"�");
+    CHECK(ToUtf16("\xE2\x82") == u"��");
+    CHECK(ToUtf16("\xF0\x9F\x98z") == u"���z");
+}
+
+void TestOverlongUtf8() {
+    CHECK(ToUtf16("\xC0\x80") == u"��");
+    CHECK(ToUtf16("\xC1\xBF") == u"��");
+    CHECK(ToUtf16("\xE0\x80\x80") == u"���");
+    CHECK(ToUtf16("\xE0\x9F\xBF") == u"���");
+    CHECK(ToUtf16("\xF0\x80\x80\x80") == u"����");
+    CHECK(ToUtf16("\xF0\x8F\xBF\xBF") == u"����");
+}
+
+void TestSurrogates() {
+    // UTF-8 encoded surrogates and code points above U+10FFFF are invalid
+    CHECK(ToUtf16("\xED\xA0\x80") == u"���");
+    CHECK(ToUtf16("\xED\xBF\xBF") == u"���");
+    CHECK(ToUtf16("\xF4\x90\x80\x80") == u"����");
+
+    // Unpaired UTF-16 surrogates become U+FFFD
+    CHECK(ToUtf8(u"\xD800") == "\xEF\xBF\xBD");
+    CHECK(ToUtf8(u"\xDC00") == "\xEF\xBF\xBD");
+    CHECK(ToUtf8(u"\xD800" u"A") == "\xEF\xBF\xBD" "A");
+    CHECK(ToUtf8(u"\xDC00\xD800") == "\xEF\xBF\xBD\xEF\xBF\xBD");
+    CHECK(ToUtf8(u"A\xDBFF") == "A\xEF\xBF\xBD");
+}
+
+void TestUtf16Le() {
+    const uint8_t bytes[] = {'H', 0, 'i', 0, 0xAC, 0x20, 'x'};
+    std::string out;
+    Utf16LeToUtf8(bytes, sizeof(bytes), out);
+    CHECK(out == "Hi\xE2\x82\xAC");
+
+    // A trailing odd byte is not a code unit
+    Utf16LeToUtf8(bytes, 3, out);
+    CHECK(out == "H");
+}
+
+void TestBufferReuse() {
+    std::u16string wide;
+    Utf8ToUtf16(std::string(100, 'x'), wide);
+    Utf8ToUtf16("ab", wide);
+    CHECK(wide == u"ab");
+
+    std::string narrow;
+    Utf16ToUtf8(u"long text", 9, narrow);
+    Utf16ToUtf8(u"z", 1, narrow);
+    CHECK(narrow == "z");
+}
+
+void TestFoldCase() {
+    CHECK(FoldCase("Software\\Classes") == "SOFTWARE\\CLASSES");
+    CHECK(FoldCase("привет") == FoldCase("ПРИВЕТ"));
+    CHECK(FoldCase("ÿes") == FoldCase("ŸES"));
+    CHECK(FoldCase("Straße") != FoldCase("STRASSE"));
+    CHECK(FoldCase("алфавит") != FoldCase("привет"));
+
+    std::string key = "prefix:";
+    AppendFoldedCase("Zeta", key);
+    CHECK(key == "prefix:ZETA");
+
+    CHECK(UpcaseChar(u'a') == u'A');
+    CHECK(UpcaseChar(u'ÿ') == u'Ÿ');
+    CHECK(UpcaseChar(u'я') == u'Я');
+    CHECK(UpcaseChar(u'ā') == u'Ā');
+    CHECK(UpcaseChar(u'Ā') == u'Ā');
+    CHECK(UpcaseChar(u'ß') == u'ß');
+    CHECK(UpcaseChar(u'ı') == u'ı');
+    CHECK(UpcaseChar(u'7') == u'7');
+}
+
+} // namespace
+
+int main() {
+    TestAsciiRuns();
+    TestValidMultibyte();
+    TestInvalidUtf8();
+    TestOverlongUtf8();
+    TestSurrogates();
+    TestUtf16Le();
+    TestBufferReuse();
+    TestFoldCase();
+    return test::TestResult();
+}
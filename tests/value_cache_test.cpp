@@ -0,0 +1,97 @@
+#include "test_support.h"
+#include "value_cache.h"
+#include <algorithm>
+#include <sstream>
+
+using namespace registry;
+
+namespace {
+
+std::vector<uint8_t> Pattern(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 13 + i / 509);
+    }
+    return bytes;
+}
+
+// Serves chunks of an in-memory buffer and counts the loads
+class BufferLargeValue : public CachedLargeValue {
+public:
+    BufferLargeValue(std::vector<uint8_t> data, const ValueIdentity& identity, std::shared_ptr<ChunkCache> cache)
+        : CachedLargeValue(data.size(), identity, std::move(cache)), data_(std::move(data)) {
+    }
+
+    size_t Loads() const { return loads_; }
+
+protected:
+    bool LoadChunk(size_t index, std::vector<uint8_t>& out) const override {
+        ++loads_;
+        size_t offset = index * kValueChunkSize;
+        if (offset >= data_.size()) {
+            return false;
+        }
+        out.assign(data_.begin() + static_cast<std::ptrdiff_t>(offset),
+                   data_.begin() + static_cast<std::ptrdiff_t>(std::min(offset + kValueChunkSize, data_.size())));
+        return true;
+    }
+
+private:
+    std::vector<uint8_t> data_;
+    mutable size_t loads_ = 0;
+};
+
+ChunkCache::Chunk MakeChunk(uint8_t byte) {
+    return std::make_shared<const std::vector<uint8_t>>(16, byte);
+}
+
+// Identities that agree on every numeric field but name different values
+// must not share chunks
+void TestIdentityNames() {
+    ChunkCache cache(1024);
+    ValueIdentity first{1, 2, 3, "SOFTWARE\\APP" + std::string(1, '\0') + "A"};
+    ValueIdentity second = first;
+    second.name.back() = 'B';
+
+    cache.Insert(first, 0, MakeChunk(0xAA));
+    CHECK(cache.Find(second, 0) == nullptr);
+    cache.Insert(second, 0, MakeChunk(0xBB));
+    auto chunk = cache.Find(first, 0);
+    CHECK(chunk && (*chunk)[0] == 0xAA);
+    chunk = cache.Find(second, 0);
+    CHECK(chunk && (*chunk)[0] == 0xBB);
+    CHECK(cache.Bytes() == 32);
+}
+
+// Streaming a value larger than the cache reads each chunk once and leaves
+// the cache within its budget
+void TestStreamLargerThanCache() {
+    const size_t kBudget = 2 * kValueChunkSize;
+    const std::vector<uint8_t> data = Pattern(5 * kValueChunkSize + 123);
+    auto cache = std::make_shared<ChunkCache>(kBudget);
+    BufferLargeValue value(data, {7, 1, 42, ""}, cache);
+
+    std::ostringstream out;
+    CHECK(value.StreamTo(out));
+    std::string streamed = out.str();
+    CHECK(streamed.size() == data.size());
+    CHECK(std::equal(data.begin(), data.end(), reinterpret_cast<const uint8_t*>(streamed.data())));
+    CHECK(value.Loads() == 6);
+    CHECK(cache->Bytes() <= kBudget);
+    CHECK(cache->Bytes() == kValueChunkSize + 123);
+
+    // Without a cache every read goes to the source
+    BufferLargeValue uncached(data, {7, 1, 42, ""}, nullptr);
+    std::ostringstream again;
+    CHECK(uncached.StreamTo(again));
+    CHECK(again.str() == streamed);
+    CHECK(uncached.Loads() == 6);
+}
+
+} // namespace
+
+int main() {
+    TestIdentityNames();
+    TestStreamLargerThanCache();
+    return test::TestResult();
+}
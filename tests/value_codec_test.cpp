@@ -0,0 +1,183 @@
+#include "test_support.h"
+#include "value_codec.h"
+#include <string>
+#include <vector>
+
+using namespace registry;
+
+namespace {
+
+ValueData Decode(ValueType type, const std::vector<uint8_t>& bytes) {
+    return DecodeValueData(type, bytes.data(), bytes.size());
+}
+
+std::vector<uint8_t> Utf16Le(const std::u16string& units) {
+    std::vector<uint8_t> bytes;
+    for (char16_t unit : units) {
+        bytes.push_back(static_cast<uint8_t>(unit));
+        bytes.push_back(static_cast<uint8_t>(unit >> 8));
+    }
+    return bytes;
+}
+
+using Strings = std::vector<std::string>;
+
+void TestStrings() {
+    CHECK(Decode(ValueType::REG_SZ, Utf16Le(u"Hi\0")) == ValueData(std::string("Hi")));
+    CHECK(Decode(ValueType::REG_EXPAND_SZ, Utf16Le(u"%PATH%\0")) == ValueData(std::string("%PATH%")));
+
+    // Unterminated, and with data after the terminator
+    CHECK(Decode(ValueType::REG_SZ, Utf16Le(u"Hi")) == ValueData(std::string("Hi")));
+    CHECK(Decode(ValueType::REG_SZ, Utf16Le(u"Hi\0junk")) == ValueData(std::string("Hi")));
+
+    // A trailing odd byte is dropped
+    std::vector<uint8_t> odd = Utf16Le(u"AB");
+    odd.push_back('C');
+    CHECK(Decode(ValueType::REG_SZ, odd) == ValueData(std::string("AB")));
+    CHECK(Decode(ValueType::REG_SZ, {'A'}) == ValueData(std::string()));
+    CHECK(Decode(ValueType::REG_SZ, {}) == ValueData(std::string()));
+
+    CHECK(Decode(ValueType::REG_SZ, Utf16Le(u"привет")) == ValueData(std::string("привет")));
+}
+
+void TestMultiStrings() {
+    CHECK(Decode(ValueType::REG_MULTI_SZ, Utf16Le(std::u16string(u"a\0bc\0\0", 6))) ==
+          ValueData(Strings{"a", "bc"}));
+
+    // Final list terminator missing
+    CHECK(Decode(ValueType::REG_MULTI_SZ, Utf16Le(std::u16string(u"a\0bc\0", 5))) ==
+          ValueData(Strings{"a", "bc"}));
+
+    // Both terminators missing
+    CHECK(Decode(ValueType::REG_MULTI_SZ, Utf16Le(std::u16string(u"a\0bc", 4))) ==
+          ValueData(Strings{"a", "bc"}));
+
+    // Odd byte count, with the odd byte after a terminator and inside a string
+    std::vector<uint8_t> odd = Utf16Le(std::u16string(u"a\0", 2));
+    odd.push_back('b');
+    CHECK(Decode(ValueType::REG_MULTI_SZ, odd) == ValueData(Strings{"a"}));
+    odd = Utf16Le(u"ab");
+    odd.push_back('c');
+    CHECK(Decode(ValueType::REG_MULTI_SZ, odd) == ValueData(Strings{"ab"}));
+
+    // An empty string ends the list
+    CHECK(Decode(ValueType::REG_MULTI_SZ, Utf16Le(std::u16string(u"a\0\0b\0\0", 6))) ==
+          ValueData(Strings{"a"}));
+    CHECK(Decode(ValueType::REG_MULTI_SZ, {}) == ValueData(Strings{}));
+    CHECK(Decode(ValueType::REG_MULTI_SZ, {0, 0}) == ValueData(Strings{}));
+}
+
+void TestNumbers() {
+    CHECK(Decode(ValueType::REG_DWORD, {0x78, 0x56, 0x34, 0x12}) == ValueData(uint32_t{0x12345678}));
+    CHECK(Decode(ValueType::REG_DWORD_BIG_ENDIAN, {0x12, 0x34, 0x56, 0x78}) ==
+          ValueData(uint32_t{0x12345678}));
+    CHECK(Decode(ValueType::REG_QWORD, {1, 2, 3, 4, 5, 6, 7, 8}) ==
+          ValueData(uint64_t{0x0807060504030201ULL}));
+
+    // Short data: missing bytes read as zero
+    CHECK(Decode(ValueType::REG_DWORD, {0x01, 0x02}) == ValueData(uint32_t{0x0201}));
+    CHECK(Decode(ValueType::REG_DWORD, {}) == ValueData(uint32_t{0}));
+    CHECK(Decode(ValueType::REG_DWORD_BIG_ENDIAN, {0x01, 0x02}) == ValueData(uint32_t{0x01020000}));
+    CHECK(Decode(ValueType::REG_QWORD, {0x01, 0x02, 0x03}) == ValueData(uint64_t{0x030201}));
+    CHECK(Decode(ValueType::REG_QWORD, {}) == ValueData(uint64_t{0}));
+
+    // Long data: extra bytes are ignored
+    CHECK(Decode(ValueType::REG_DWORD, {1, 0, 0, 0, 9, 9}) == ValueData(uint32_t{1}));
+}
+
+void TestBinaryAndNull() {
+    CHECK(Decode(ValueType::REG_BINARY, {1, 2, 3}) == ValueData(std::vector<uint8_t>{1, 2, 3}));
+    CHECK(Decode(ValueType::REG_RESOURCE_LIST, {7}) == ValueData(std::vector<uint8_t>{7}));
+    CHECK(Decode(ValueType::REG_NONE, {1, 2}) == ValueData(std::vector<uint8_t>{1, 2}));
+
+    // A null pointer is read as empty whatever the size
+    CHECK(DecodeValueData(ValueType::REG_BINARY, nullptr, 16) == ValueData(std::vector<uint8_t>{}));
+    CHECK(DecodeValueData(ValueType::REG_SZ, nullptr, 16) == ValueData(std::string()));
+}
+
+void TestReuse() {
+    ValueData data = std::string("previous");
+    std::vector<uint8_t> bytes = Utf16Le(u"x");
+    DecodeValueData(ValueType::REG_SZ, bytes.data(), bytes.size(), data);
+    CHECK(data == ValueData(std::string("x")));
+
+    DecodeValueData(ValueType::REG_MULTI_SZ, bytes.data(), bytes.size(), data);
+    CHECK(data == ValueData(Strings{"x"}));
+    DecodeValueData(ValueType::REG_MULTI_SZ, nullptr, 0, data);
+    CHECK(data == ValueData(Strings{}));
+}
+
+void TestEncodeRoundTrip() {
+    const Value values[] = {
+        {"s", ValueType::REG_SZ, std::string("Zeta ÿ")},
+        {"e", ValueType::REG_EXPAND_SZ, std::string("%SystemRoot%")},
+        {"d", ValueType::REG_DWORD, uint32_t{42}},
+        {"b", ValueType::REG_DWORD_BIG_ENDIAN, uint32_t{0x01020304}},
+        {"q", ValueType::REG_QWORD, uint64_t{1} << 40},
+        {"m", ValueType::REG_MULTI_SZ, Strings{"one", "два"}},
+        {"x", ValueType::REG_BINARY, std::vector<uint8_t>{0, 255, 7}},
+    };
+    for (const auto& value : values) {
+        std::vector<uint8_t> bytes;
+        CHECK(EncodeValueData(value, bytes));
+        CHECK(Decode(value.type, bytes) == value.data);
+        CHECK(ValueTypeFromRaw(ValueTypeToRaw(value.type)) == value.type);
+    }
+
+    std::vector<uint8_t> bytes;
+    CHECK(EncodeValueData({"n", ValueType::REG_NONE, std::monostate{}}, bytes));
+    CHECK(bytes.empty());
+    CHECK(!EncodeValueData({"bad", ValueType::REG_DWORD, std::string("1")}, bytes));
+    CHECK(!EncodeValueData({"bad", ValueType::REG_SZ, uint32_t{1}}, bytes));
+    CHECK(ValueTypeFromRaw(0x1234) == ValueType::UNKNOWN);
+}
+
+// REG_NONE and types without a ValueType (REG_FULL_RESOURCE_DESCRIPTOR = 9,
+// REG_RESOURCE_REQUIREMENTS_LIST = 10) keep both their data and type code
+void TestRawTypesRoundTrip() {
+    for (uint32_t raw : {0u, 9u, 10u, 0x1234u}) {
+        const std::vector<uint8_t> stored = {0xDE, 0xAD, 0x00, 0xBE, 0xEF};
+        Value value{"v", ValueTypeFromRaw(raw), {}};
+        value.rawType = raw;
+        DecodeValueData(value.type, stored.data(), stored.size(), value.data);
+        CHECK(value.data == ValueData(stored));
+        CHECK(RawValueType(value) == raw);
+
+        std::vector<uint8_t> bytes;
+        CHECK(EncodeValueData(value, bytes));
+        CHECK(bytes == stored);
+    }
+
+    // The raw code only matters for unmapped types
+    Value binary{"b", ValueType::REG_BINARY, std::vector<uint8_t>{1}};
+    binary.rawType = 9;
+    CHECK(RawValueType(binary) == 3);
+}
+
+// A large value carries its data in `large`, never in `data`
+struct FakeLargeValue : LargeValue {
+    size_t Size() const override { return 1 << 20; }
+    size_t ReadChunk(size_t, uint8_t*, size_t) const override { return 0; }
+};
+
+void TestEncodeRejectsLargeValues() {
+    Value value{"big", ValueType::REG_BINARY, std::monostate{}};
+    value.large = std::make_shared<FakeLargeValue>();
+    std::vector<uint8_t> bytes{1, 2, 3};
+    CHECK(!EncodeValueData(value, bytes));
+    CHECK(bytes.empty());
+}
+
+} // namespace
+
+int main() {
+    TestStrings();
+    TestMultiStrings();
+    TestNumbers();
+    TestBinaryAndNull();
+    TestReuse();
+    TestEncodeRoundTrip();
+    TestRawTypesRoundTrip();
+    TestEncodeRejectsLargeValues();
+    return test::TestResult();
+}